@@ -1,16 +1,131 @@
 #version 450 core
 
 in vec2 vUV;
+flat in int vSource;
 out vec4 FragColor;
 
-uniform sampler2D uTex;
+const int MAX_SOURCES = 4;
+// Per source: texture units 3 * source + plane
+uniform sampler2D uPlane0[MAX_SOURCES]; // RGB, the Y plane, or packed Y/CbCr texels
+uniform sampler2D uPlane1[MAX_SOURCES]; // CbCr plane (R = Cb, G = Cr), or the Cb plane
+uniform sampler2D uPlane2[MAX_SOURCES]; // Cr plane of three-plane formats
 uniform int uFlipY;
+uniform int uFormat[MAX_SOURCES];     // -1 = no frame yet, 0 = RGB, 1 = Y + interleaved CbCr (NV12/NV16/P010),
+                                      // 2 = packed 4:2:2 (Y210), 3 = Y + Cb + Cr planes (I420/I422)
+uniform int uMatrix[MAX_SOURCES];     // 0 = BT.601, 1 = BT.709, 2 = BT.2020
+uniform int uFullRange[MAX_SOURCES];  // 0 = limited (16-235/240), 1 = full range
+uniform int uBitDepth[MAX_SOURCES];   // 8, or 10 for 16-bit samples with 10 bits in the high bits
+
+// Sampler arrays may only be indexed with dynamically uniform values and
+// the source changes per instance, so pick the sampler with constant indices
+vec4 SamplePlane0(int s, vec2 uv)
+{
+    if (s == 1) return texture(uPlane0[1], uv);
+    if (s == 2) return texture(uPlane0[2], uv);
+    if (s == 3) return texture(uPlane0[3], uv);
+    return texture(uPlane0[0], uv);
+}
+
+vec4 SamplePlane1(int s, vec2 uv)
+{
+    if (s == 1) return texture(uPlane1[1], uv);
+    if (s == 2) return texture(uPlane1[2], uv);
+    if (s == 3) return texture(uPlane1[3], uv);
+    return texture(uPlane1[0], uv);
+}
+
+vec4 SamplePlane2(int s, vec2 uv)
+{
+    if (s == 1) return texture(uPlane2[1], uv);
+    if (s == 2) return texture(uPlane2[2], uv);
+    if (s == 3) return texture(uPlane2[3], uv);
+    return texture(uPlane2[0], uv);
+}
+
+vec4 FetchPlane0(int s, ivec2 texel)
+{
+    if (s == 1) return texelFetch(uPlane0[1], texel, 0);
+    if (s == 2) return texelFetch(uPlane0[2], texel, 0);
+    if (s == 3) return texelFetch(uPlane0[3], texel, 0);
+    return texelFetch(uPlane0[0], texel, 0);
+}
+
+ivec2 Plane0Size(int s)
+{
+    if (s == 1) return textureSize(uPlane0[1], 0);
+    if (s == 2) return textureSize(uPlane0[2], 0);
+    if (s == 3) return textureSize(uPlane0[3], 0);
+    return textureSize(uPlane0[0], 0);
+}
+
+vec3 YCbCrToRgb(float y, vec2 c, int matrix, int fullRange, int bitDepth)
+{
+    // Back to code values at the source bit depth; one 8-bit step is
+    // four 10-bit steps
+    float codeScale = (bitDepth == 10) ? 65535.0 / 64.0 : 255.0;
+    float unit = (bitDepth == 10) ? 4.0 : 1.0;
+    y *= codeScale;
+    c *= codeScale;
+
+    if (fullRange == 1) {
+        float maxCode = (bitDepth == 10) ? 1023.0 : 255.0;
+        y /= maxCode;
+        c = (c - 128.0 * unit) / maxCode;
+    } else {
+        y = (y - 16.0 * unit) / (219.0 * unit);
+        c = (c - 128.0 * unit) / (224.0 * unit);
+    }
+
+    // Kr/Kb derived coefficients for each matrix
+    vec3 rgb;
+    if (matrix == 2) {
+        rgb = vec3(y + 1.4746 * c.y,
+                   y - 0.1646 * c.x - 0.5714 * c.y,
+                   y + 1.8814 * c.x);
+    } else if (matrix == 1) {
+        rgb = vec3(y + 1.5748 * c.y,
+                   y - 0.1873 * c.x - 0.4681 * c.y,
+                   y + 1.8556 * c.x);
+    } else {
+        rgb = vec3(y + 1.4020 * c.y,
+                   y - 0.3441 * c.x - 0.7141 * c.y,
+                   y + 1.7720 * c.x);
+    }
+    return clamp(rgb, 0.0, 1.0);
+}
 
 void main()
 {
+    int src = vSource;
     vec2 uv = vUV;
     if (uFlipY == 1)
         uv.y = 1.0 - uv.y;
 
-    FragColor = texture(uTex, uv);
+    int format = uFormat[src];
+    int matrix = uMatrix[src];
+    int fullRange = uFullRange[src];
+    int bitDepth = uBitDepth[src];
+    if (format == 1) {
+        float y = SamplePlane0(src, uv).r;
+        vec2 c = SamplePlane1(src, uv).rg;
+        FragColor = vec4(YCbCrToRgb(y, c, matrix, fullRange, bitDepth), 1.0);
+    } else if (format == 3) {
+        float y = SamplePlane0(src, uv).r;
+        vec2 c = vec2(SamplePlane1(src, uv).r, SamplePlane2(src, uv).r);
+        FragColor = vec4(YCbCrToRgb(y, c, matrix, fullRange, bitDepth), 1.0);
+    } else if (format == 2) {
+        // R is luma for every texel and can be filtered; G alternates Cb/Cr,
+        // so chroma is fetched unfiltered from the pixel pair
+        float y = SamplePlane0(src, uv).r;
+        ivec2 size = Plane0Size(src);
+        ivec2 texel = clamp(ivec2(uv * vec2(size)), ivec2(0), size - 1);
+        int x0 = texel.x & ~1;
+        vec2 c = vec2(FetchPlane0(src, ivec2(x0, texel.y)).g,
+                      FetchPlane0(src, ivec2(x0 + 1, texel.y)).g);
+        FragColor = vec4(YCbCrToRgb(y, c, matrix, fullRange, bitDepth), 1.0);
+    } else if (format == 0) {
+        FragColor = SamplePlane0(src, uv);
+    } else {
+        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
+    }
 }
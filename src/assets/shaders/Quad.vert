@@ -3,10 +3,17 @@
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec2 aUV;
 
+const int MAX_SOURCES = 4;
+uniform vec4 uRect[MAX_SOURCES]; // Per source: x, y, width, height in NDC
+
 out vec2 vUV;
+flat out int vSource;
 
 void main()
 {
+    // One instance per source; the unit quad is placed in that source's tile
+    vec4 rect = uRect[gl_InstanceID];
     vUV = aUV;
-    gl_Position = vec4(aPos, 0.0, 1.0);
+    vSource = gl_InstanceID;
+    gl_Position = vec4(rect.xy + (aPos * 0.5 + 0.5) * rect.zw, 0.0, 1.0);
 }
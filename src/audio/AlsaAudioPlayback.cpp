@@ -0,0 +1,252 @@
+#include "AlsaAudioPlayback.h"
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <stdexcept>
+
+namespace uvc2gl {
+
+AlsaAudioPlayback::AlsaAudioPlayback(const std::string& device,
+                                     unsigned int sampleRate,
+                                     unsigned int channels,
+                                     snd_pcm_uframes_t periodSize,
+                                     unsigned int periods,
+                                     unsigned int startPeriods)
+    : AudioPlayback(sampleRate, channels)
+    , m_Device(device)
+    , m_Handle(nullptr)
+    , m_Channels(channels)
+    , m_PeriodSize(periodSize)
+    , m_BufferSize(0)
+    , m_Mmap(true)
+{
+    auto fail = [this](const std::string& what, int err) {
+        if (m_Handle) {
+            snd_pcm_close(m_Handle);
+            m_Handle = nullptr;
+        }
+        throw std::runtime_error(what + " (" + m_Device + "): " + snd_strerror(err));
+    };
+
+    // Blocking handle: the output thread sleeps in snd_pcm_wait() between periods
+    int err = snd_pcm_open(&m_Handle, m_Device.c_str(), SND_PCM_STREAM_PLAYBACK, 0);
+    if (err < 0) {
+        fail("Cannot open audio output", err);
+    }
+
+    snd_pcm_hw_params_t* params;
+    snd_pcm_hw_params_alloca(&params);
+    err = snd_pcm_hw_params_any(m_Handle, params);
+    if (err < 0) {
+        fail("Cannot initialize hardware parameters", err);
+    }
+
+    // Render straight into the device buffer where the PCM allows it
+    err = snd_pcm_hw_params_set_access(m_Handle, params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    if (err < 0) {
+        m_Mmap = false;
+        err = snd_pcm_hw_params_set_access(m_Handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
+    }
+    if (err < 0) {
+        fail("Cannot set access type", err);
+    }
+
+    err = snd_pcm_hw_params_set_format(m_Handle, params, SND_PCM_FORMAT_S16_LE);
+    if (err < 0) {
+        fail("Cannot set sample format", err);
+    }
+
+    err = snd_pcm_hw_params_set_channels_near(m_Handle, params, &m_Channels);
+    if (err < 0) {
+        fail("Cannot set channel count", err);
+    }
+
+    unsigned int actualRate = sampleRate;
+    err = snd_pcm_hw_params_set_rate_near(m_Handle, params, &actualRate, 0);
+    if (err < 0) {
+        fail("Cannot set sample rate", err);
+    }
+
+    err = snd_pcm_hw_params_set_period_size_near(m_Handle, params, &m_PeriodSize, 0);
+    if (err < 0) {
+        fail("Cannot set period size", err);
+    }
+
+    // Few periods: everything in the device buffer is latency
+    m_BufferSize = m_PeriodSize * std::max(2u, periods);
+    err = snd_pcm_hw_params_set_buffer_size_near(m_Handle, params, &m_BufferSize);
+    if (err < 0) {
+        fail("Cannot set buffer size", err);
+    }
+
+    err = snd_pcm_hw_params(m_Handle, params);
+    if (err < 0) {
+        fail("Cannot set hardware parameters", err);
+    }
+    snd_pcm_hw_params_get_period_size(params, &m_PeriodSize, 0);
+    snd_pcm_hw_params_get_buffer_size(params, &m_BufferSize);
+
+    // Start on our own threshold rather than the default (a full buffer),
+    // and wake the thread whenever a whole period is free
+    snd_pcm_sw_params_t* swParams;
+    snd_pcm_sw_params_alloca(&swParams);
+    err = snd_pcm_sw_params_current(m_Handle, swParams);
+    if (err < 0) {
+        fail("Cannot read software parameters", err);
+    }
+    const snd_pcm_uframes_t startThreshold = std::min(m_BufferSize, m_PeriodSize * std::max(1u, startPeriods));
+    snd_pcm_sw_params_set_start_threshold(m_Handle, swParams, startThreshold);
+    snd_pcm_sw_params_set_avail_min(m_Handle, swParams, m_PeriodSize);
+    err = snd_pcm_sw_params(m_Handle, swParams);
+    if (err < 0) {
+        fail("Cannot set software parameters", err);
+    }
+
+    if (!m_Mmap) {
+        m_Buffer.resize(m_PeriodSize * m_Channels);
+    }
+
+    std::cout << "ALSA playback initialized on " << m_Device << ": " << actualRate << "Hz, "
+              << m_Channels << " channels, " << m_PeriodSize << " frames/period, "
+              << m_BufferSize << " frames buffered, start at " << startThreshold
+              << (m_Mmap ? " (mmap)" : " (write)") << std::endl;
+
+    ConfigureOutput(actualRate, m_Channels, m_PeriodSize);
+    SetOutputDelay(static_cast<double>(startThreshold), false); // until the first measurement
+}
+
+AlsaAudioPlayback::~AlsaAudioPlayback() {
+    try {
+        Stop();
+    } catch (...) {
+        std::cerr << "Exception in AlsaAudioPlayback destructor" << std::endl;
+    }
+    if (m_Handle) {
+        snd_pcm_close(m_Handle);
+        m_Handle = nullptr;
+    }
+}
+
+void AlsaAudioPlayback::Start() {
+    if (m_Running.exchange(true)) {
+        return;
+    }
+    // A loop that stopped itself after an error has exited but isn't joined
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+
+    int err = snd_pcm_prepare(m_Handle);
+    if (err < 0) {
+        std::cerr << "Cannot prepare audio output: " << snd_strerror(err) << std::endl;
+        m_Running = false;
+        return;
+    }
+    m_Thread = std::thread(&AlsaAudioPlayback::OutputLoop, this);
+    std::cout << "Audio playback started" << std::endl;
+}
+
+void AlsaAudioPlayback::Stop() {
+    const bool running = m_Running.exchange(false);
+    // snd_pcm_wait() times out regularly, so the thread sees the flag. Also
+    // joins a loop that already stopped itself after an error.
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+    if (!running) {
+        return;
+    }
+    snd_pcm_drop(m_Handle);
+    std::cout << "Audio playback stopped" << std::endl;
+}
+
+snd_pcm_sframes_t AlsaAudioPlayback::WritePeriod() {
+    if (!m_Mmap) {
+        Render(m_Buffer.data(), m_PeriodSize);
+        return snd_pcm_writei(m_Handle, m_Buffer.data(), m_PeriodSize);
+    }
+
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset = 0;
+    snd_pcm_uframes_t frames = m_PeriodSize; // may come back shorter at the buffer's wrap
+    int err = snd_pcm_mmap_begin(m_Handle, &areas, &offset, &frames);
+    if (err < 0) {
+        return err;
+    }
+
+    // Interleaved S16: one area whose step is a whole frame
+    int16_t* dst = reinterpret_cast<int16_t*>(static_cast<uint8_t*>(areas[0].addr) +
+                                              (areas[0].first + offset * areas[0].step) / 8);
+    Render(dst, frames);
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_Handle, offset, frames);
+    if (committed >= 0 && static_cast<snd_pcm_uframes_t>(committed) != frames) {
+        return -EPIPE;
+    }
+    return committed;
+}
+
+bool AlsaAudioPlayback::Recover(int err) {
+    if (err == -EPIPE) {
+        m_DeviceXruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Re-prepares the PCM; the start threshold restarts it once refilled
+    err = snd_pcm_recover(m_Handle, err, 1);
+    if (err < 0) {
+        std::cerr << "Audio output error: " << snd_strerror(err) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void AlsaAudioPlayback::OutputLoop() {
+    while (m_Running.load()) {
+        ApplyPendingThreadPolicy("uvc2gl-alsaout");
+
+        snd_pcm_sframes_t avail = snd_pcm_avail_update(m_Handle);
+        if (avail < 0) {
+            if (!Recover(static_cast<int>(avail))) {
+                break;
+            }
+            continue;
+        }
+
+        if (static_cast<snd_pcm_uframes_t>(avail) < m_PeriodSize) {
+            if (snd_pcm_state(m_Handle) == SND_PCM_STATE_PREPARED) {
+                // Buffer full but below the start threshold (a short final
+                // write); start by hand or it would wait forever
+                snd_pcm_start(m_Handle);
+            }
+            int err = snd_pcm_wait(m_Handle, 100);
+            if (err < 0 && !Recover(err)) {
+                break;
+            }
+            continue;
+        }
+
+        // Fill every whole period that's free, then measure what's queued
+        bool failed = false;
+        while (avail >= static_cast<snd_pcm_sframes_t>(m_PeriodSize)) {
+            snd_pcm_sframes_t written = WritePeriod();
+            if (written < 0) {
+                failed = !Recover(static_cast<int>(written));
+                break;
+            }
+            avail -= written;
+        }
+        if (failed) {
+            break;
+        }
+
+        snd_pcm_sframes_t delay = 0;
+        if (snd_pcm_delay(m_Handle, &delay) == 0) {
+            SetOutputDelay(static_cast<double>(std::max<snd_pcm_sframes_t>(0, delay)), true);
+        }
+    }
+
+    // Not running any more, so IsRunning() tells the application to reopen
+    if (m_Running.exchange(false)) {
+        std::cerr << "Audio output on " << m_Device << " stopped after an error" << std::endl;
+    }
+}
+
+} // namespace uvc2gl
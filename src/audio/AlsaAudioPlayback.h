@@ -0,0 +1,49 @@
+#pragma once
+
+#include "AudioPlayback.h"
+#include <alsa/asoundlib.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace uvc2gl {
+
+// Plays straight to an ALSA PCM, bypassing the sound server. Small periods
+// are rendered directly into the device's mmap area (plain writes if the
+// PCM can't map), and snd_pcm_delay() gives the measured output latency.
+// Works against any PCM name, including the "null" and "file" plugins.
+class AlsaAudioPlayback : public AudioPlayback {
+public:
+    // The device starts once startPeriods periods are written, leaving the
+    // rest of the buffer as headroom for a late wakeup
+    AlsaAudioPlayback(const std::string& device = "default",
+                      unsigned int sampleRate = 48000,
+                      unsigned int channels = 2,
+                      snd_pcm_uframes_t periodSize = 256,
+                      unsigned int periods = 3,
+                      unsigned int startPeriods = 2);
+    ~AlsaAudioPlayback() override;
+
+    const char* Name() const override { return "alsa"; }
+
+    void Start() override;
+    void Stop() override;
+
+private:
+    void OutputLoop();
+    // Renders and commits up to one period; frames written or a negative errno
+    snd_pcm_sframes_t WritePeriod();
+    // Restarts after an underrun or suspend; false if the device is gone
+    bool Recover(int err);
+
+    std::string m_Device;
+    snd_pcm_t* m_Handle;
+    unsigned int m_Channels;
+    snd_pcm_uframes_t m_PeriodSize;
+    snd_pcm_uframes_t m_BufferSize;
+    bool m_Mmap;                    // Rendering into the mmap area, else writei from m_Buffer
+    std::vector<int16_t> m_Buffer;  // One period, for the writei path
+    std::thread m_Thread;
+};
+
+} // namespace uvc2gl
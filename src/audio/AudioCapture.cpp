@@ -1,8 +1,24 @@
 #include "AudioCapture.h"
+#include <cerrno>
+#include <chrono>
 #include <iostream>
+#include <stdexcept>
 
 namespace uvc2gl {
 
+// In order of preference: S16 needs no conversion, the rest are what cards
+// without it offer (HDMI and pro interfaces)
+static const struct {
+    snd_pcm_format_t alsa;
+    SampleFormat format;
+} kCaptureFormats[] = {
+    { SND_PCM_FORMAT_S16_LE, SampleFormat::S16 },
+    { SND_PCM_FORMAT_S32_LE, SampleFormat::S32 },
+    { SND_PCM_FORMAT_S24_LE, SampleFormat::S24 },
+    { SND_PCM_FORMAT_S24_3LE, SampleFormat::S24_3 },
+    { SND_PCM_FORMAT_FLOAT_LE, SampleFormat::F32 },
+};
+
 AudioCapture::AudioCapture(const std::string& device, 
                            unsigned int sampleRate,
                            unsigned int channels,
@@ -13,11 +29,7 @@ AudioCapture::AudioCapture(const std::string& device,
     , m_PeriodSize(periodSize)
     , m_Handle(nullptr)
     , m_Running(false)
-    , m_BufferA(periodSize, sampleRate, channels)
-    , m_BufferB(periodSize, sampleRate, channels)
 {
-    m_WriteBuffer = &m_BufferA;
-    m_ReadBuffer = &m_BufferB;
 }
 
 AudioCapture::~AudioCapture() {
@@ -33,47 +45,86 @@ void AudioCapture::Start() {
     if (m_Running.exchange(true)) {
         return; // Already running
     }
-    
-    m_CaptureThread = std::thread(&AudioCapture::CaptureLoop, this);
+
+    if (!InitializeALSA()) {
+        std::cerr << "Failed to initialize ALSA" << std::endl;
+        m_Running = false;
+        return;
+    }
+
+    try {
+        if (!m_Reactor) {
+            m_Reactor = std::make_shared<IoReactor>(); // standalone: a reactor thread of our own
+        }
+
+        // Watch every descriptor the PCM exposes; the handler translates
+        // their events back through ALSA, which may remap them
+        int count = snd_pcm_poll_descriptors_count(m_Handle);
+        m_PollFds.resize(count > 0 ? count : 0);
+        count = snd_pcm_poll_descriptors(m_Handle, m_PollFds.data(), m_PollFds.size());
+        m_PollFds.resize(count > 0 ? count : 0);
+        for (size_t i = 0; i < m_PollFds.size(); ++i) {
+            int id = m_Reactor->Add(m_PollFds[i].fd, m_PollFds[i].events,
+                                    [this, i](uint32_t events) { OnReadable(static_cast<int>(i), events); });
+            if (id < 0) {
+                throw std::runtime_error("Failed to watch audio device " + m_Device);
+            }
+            m_ReactorIds.push_back(id);
+        }
+
+        int err = snd_pcm_start(m_Handle);
+        if (err < 0) {
+            throw std::runtime_error("Cannot start audio device: " + std::string(snd_strerror(err)));
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Audio capture error: " << e.what() << std::endl;
+        Stop();
+        return;
+    }
+
+    std::cout << "Audio capture started" << std::endl;
 }
 
 void AudioCapture::Stop() {
-    if (!m_Running.exchange(false)) {
+    m_Running = false;
+    if (!m_Handle) {
         return; // Not running
     }
-    
+
     try {
-        if (m_CaptureThread.joinable()) {
-            m_CaptureThread.join();
+        // Once removed no handler is running, so the PCM can be closed
+        for (int id : m_ReactorIds) {
+            m_Reactor->Remove(id);
         }
     } catch (const std::exception& e) {
-        std::cerr << "Error joining audio capture thread: " << e.what() << std::endl;
+        std::cerr << "Error stopping audio capture: " << e.what() << std::endl;
     } catch (...) {
-        std::cerr << "Unknown error joining audio capture thread" << std::endl;
+        std::cerr << "Unknown error stopping audio capture" << std::endl;
     }
+    m_ReactorIds.clear();
+    m_PollFds.clear();
+    CleanupALSA();
+    std::cout << "Audio capture stopped" << std::endl;
 }
 
-bool AudioCapture::GetAudioFrame(AudioFrame& frame) {
-    std::lock_guard<std::mutex> lock(m_BufferMutex);
-    
-    if (m_ReadBuffer->samples.empty() || m_ReadBuffer->frameCount == 0) {
-        return false;
-    }
-    
-    frame = *m_ReadBuffer;
-    
-    // Mark this buffer as consumed by clearing it
-    // This prevents the same audio from being played multiple times
-    m_ReadBuffer->frameCount = 0;
-    
-    return true;
+AudioCaptureStats AudioCapture::GetStats() const {
+    AudioCaptureStats stats;
+    stats.periodsCaptured = m_PeriodsCaptured.load(std::memory_order_relaxed);
+    stats.periodsDropped = m_PeriodsDropped.load(std::memory_order_relaxed);
+    stats.xruns = m_Xruns.load(std::memory_order_relaxed);
+    stats.shortReads = m_ShortReads.load(std::memory_order_relaxed);
+    stats.mmap = m_Mmap;
+    stats.hardwareTimestamps = m_HwTimestamps;
+    stats.avgLatencyMs = m_AvgLatencyMs.load(std::memory_order_relaxed);
+    return stats;
 }
 
 bool AudioCapture::InitializeALSA() {
     int err;
     
-    // Open PCM device for capture
-    err = snd_pcm_open(&m_Handle, m_Device.c_str(), SND_PCM_STREAM_CAPTURE, 0);
+    // Open PCM device for capture; reads happen when the reactor reports
+    // the poll descriptors ready, so they must never block
+    err = snd_pcm_open(&m_Handle, m_Device.c_str(), SND_PCM_STREAM_CAPTURE, SND_PCM_NONBLOCK);
     if (err < 0) {
         std::cerr << "Cannot open audio device " << m_Device << ": " 
                   << snd_strerror(err) << std::endl;
@@ -93,29 +144,47 @@ bool AudioCapture::InitializeALSA() {
         return false;
     }
     
-    // Set interleaved mode
-    err = snd_pcm_hw_params_set_access(m_Handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
+    // Read periods in place from the device buffer where the PCM allows it
+    m_Mmap = true;
+    err = snd_pcm_hw_params_set_access(m_Handle, params, SND_PCM_ACCESS_MMAP_INTERLEAVED);
+    if (err < 0) {
+        m_Mmap = false;
+        err = snd_pcm_hw_params_set_access(m_Handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
+    }
     if (err < 0) {
         std::cerr << "Cannot set access type: " << snd_strerror(err) << std::endl;
         CleanupALSA();
         return false;
     }
     
-    // Set sample format (16-bit signed integer)
-    err = snd_pcm_hw_params_set_format(m_Handle, params, SND_PCM_FORMAT_S16_LE);
+    // Set sample format: the first one the device has, converted later
+    err = -EINVAL;
+    for (const auto& candidate : kCaptureFormats) {
+        if (snd_pcm_hw_params_test_format(m_Handle, params, candidate.alsa) == 0) {
+            err = snd_pcm_hw_params_set_format(m_Handle, params, candidate.alsa);
+            m_Format = candidate.format;
+            break;
+        }
+    }
     if (err < 0) {
         std::cerr << "Cannot set sample format: " << snd_strerror(err) << std::endl;
         CleanupALSA();
         return false;
     }
     
-    // Set number of channels
-    err = snd_pcm_hw_params_set_channels(m_Handle, params, m_Channels);
+    // Set number of channels (an HDMI input may only offer 8)
+    unsigned int actualChannels = m_Channels;
+    err = snd_pcm_hw_params_set_channels_near(m_Handle, params, &actualChannels);
     if (err < 0) {
         std::cerr << "Cannot set channel count: " << snd_strerror(err) << std::endl;
         CleanupALSA();
         return false;
     }
+    if (actualChannels != m_Channels) {
+        std::cout << "Channel count adjusted from " << m_Channels
+                  << " to " << actualChannels << std::endl;
+        m_Channels = actualChannels;
+    }
     
     // Set sample rate
     unsigned int actualRate = m_SampleRate;
@@ -130,9 +199,6 @@ bool AudioCapture::InitializeALSA() {
         std::cout << "Sample rate adjusted from " << m_SampleRate 
                   << " to " << actualRate << " Hz" << std::endl;
         m_SampleRate = actualRate;
-        // Update buffer sizes to match actual rate
-        m_BufferA = AudioFrame(m_PeriodSize, m_SampleRate, m_Channels);
-        m_BufferB = AudioFrame(m_PeriodSize, m_SampleRate, m_Channels);
     }
     
     // Set period size
@@ -148,9 +214,6 @@ bool AudioCapture::InitializeALSA() {
         std::cout << "Period size adjusted from " << m_PeriodSize 
                   << " to " << actualPeriodSize << " frames" << std::endl;
         m_PeriodSize = actualPeriodSize;
-        // Update buffer sizes to match actual period
-        m_BufferA = AudioFrame(m_PeriodSize, m_SampleRate, m_Channels);
-        m_BufferB = AudioFrame(m_PeriodSize, m_SampleRate, m_Channels);
     }
     
     // Write parameters to device
@@ -162,6 +225,17 @@ bool AudioCapture::InitializeALSA() {
         return false;
     }
     
+    // Have the driver stamp every pointer update with CLOCK_MONOTONIC, the
+    // clock V4L2 stamps video buffers with
+    snd_pcm_sw_params_t* swParams;
+    snd_pcm_sw_params_alloca(&swParams);
+    m_HwTimestamps = snd_pcm_sw_params_current(m_Handle, swParams) >= 0 &&
+                     snd_pcm_sw_params_set_tstamp_mode(m_Handle, swParams, SND_PCM_TSTAMP_ENABLE) >= 0 &&
+                     snd_pcm_sw_params_set_tstamp_type(m_Handle, swParams, SND_PCM_TSTAMP_TYPE_MONOTONIC) >= 0 &&
+                     snd_pcm_sw_params(m_Handle, swParams) >= 0;
+
+    m_ReadBuffer.assign(m_Mmap ? 0 : m_PeriodSize * m_Channels * SampleBytes(m_Format), 0);
+
     // Prepare device
     err = snd_pcm_prepare(m_Handle);
     if (err < 0) {
@@ -170,8 +244,9 @@ bool AudioCapture::InitializeALSA() {
         return false;
     }
     
-    std::cout << "Audio capture initialized: " << m_SampleRate << "Hz, " 
-              << m_Channels << " channels, " << m_PeriodSize << " frames/period" << std::endl;
+    std::cout << "Audio capture initialized: " << SampleFormatName(m_Format) << ", " << m_SampleRate << "Hz, " 
+              << m_Channels << " channels, " << m_PeriodSize << " frames/period"
+              << (m_Mmap ? ", mmap" : ", read") << (m_HwTimestamps ? ", hardware timestamps" : "") << std::endl;
     
     return true;
 }
@@ -183,47 +258,117 @@ void AudioCapture::CleanupALSA() {
     }
 }
 
-void AudioCapture::CaptureLoop() {
-    if (!InitializeALSA()) {
-        std::cerr << "Failed to initialize ALSA" << std::endl;
-        return;
+void AudioCapture::OnReadable(int descriptor, uint32_t events) {
+    std::vector<struct pollfd> fds = m_PollFds;
+    fds[descriptor].revents = static_cast<short>(events);
+    unsigned short revents = 0;
+    snd_pcm_poll_descriptors_revents(m_Handle, fds.data(), fds.size(), &revents);
+    if (!(revents & (POLLIN | POLLERR))) {
+        return; // POLLERR is an overrun, recovered below
     }
-    
-    std::cout << "Audio capture thread started" << std::endl;
-    
-    while (m_Running.load()) {
-        // Read audio data into write buffer
-        snd_pcm_sframes_t frames = snd_pcm_readi(m_Handle, 
-                                                  m_WriteBuffer->samples.data(), 
-                                                  m_PeriodSize);
-        
-        if (frames < 0) {
-            // Handle errors
-            frames = snd_pcm_recover(m_Handle, frames, 0);
-            if (frames < 0) {
-                std::cerr << "Audio capture error: " << snd_strerror(frames) << std::endl;
-                break;
-            }
-            continue;
+
+    // Drain every complete period; the descriptor is level-triggered so a
+    // partial one wakes us again once it fills
+    while (true) {
+        snd_pcm_sframes_t frames = snd_pcm_avail_update(m_Handle);
+        if (frames >= static_cast<snd_pcm_sframes_t>(m_PeriodSize)) {
+            frames = ReadPeriod(frames);
+        } else if (frames >= 0) {
+            return; // less than a period waiting
         }
-        
-        if (frames != static_cast<snd_pcm_sframes_t>(m_PeriodSize)) {
-            std::cerr << "Short read: expected " << m_PeriodSize 
-                      << " frames, got " << frames << std::endl;
+        if (frames == -EAGAIN) {
+            return;
         }
-        
-        // Update the frame count for the write buffer
-        m_WriteBuffer->frameCount = frames;
-        
-        // Swap buffers
-        {
-            std::lock_guard<std::mutex> lock(m_BufferMutex);
-            std::swap(m_WriteBuffer, m_ReadBuffer);
+        if (frames < 0) {
+            // Nothing blocks on the PCM, so capture is restarted by hand
+            m_Xruns.fetch_add(1, std::memory_order_relaxed);
+            int err = snd_pcm_recover(m_Handle, static_cast<int>(frames), 0);
+            if (err >= 0) {
+                err = snd_pcm_start(m_Handle);
+            }
+            if (err < 0) {
+                std::cerr << "Audio capture error: " << snd_strerror(err) << std::endl;
+                for (int id : m_ReactorIds) {
+                    m_Reactor->Remove(id);
+                }
+                m_Running = false;
+            }
+            return;
         }
     }
-            
-            std::cout << "Audio capture thread stopped" << std::endl;
-            CleanupALSA();
+}
+
+snd_pcm_sframes_t AudioCapture::ReadPeriod(snd_pcm_sframes_t avail) {
+    const int64_t captureTimeNs = FirstFrameTime(avail);
+
+    if (!m_Mmap) {
+        snd_pcm_sframes_t frames = snd_pcm_readi(m_Handle, m_ReadBuffer.data(), m_PeriodSize);
+        if (frames > 0) {
+            Deliver(m_ReadBuffer.data(), frames, captureTimeNs);
         }
+        return frames;
+    }
+
+    const snd_pcm_channel_area_t* areas;
+    snd_pcm_uframes_t offset = 0;
+    snd_pcm_uframes_t frames = m_PeriodSize; // shorter if the period straddles the buffer's end
+    int err = snd_pcm_mmap_begin(m_Handle, &areas, &offset, &frames);
+    if (err < 0) {
+        return err;
+    }
+
+    // Interleaved: one area whose step is a whole frame. The sink reads it
+    // in place; the device can't overwrite it until it is committed.
+    const void* data = static_cast<const uint8_t*>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+    Deliver(data, frames, captureTimeNs);
+
+    snd_pcm_sframes_t committed = snd_pcm_mmap_commit(m_Handle, offset, frames);
+    if (committed >= 0 && static_cast<snd_pcm_uframes_t>(committed) != frames) {
+        return -EPIPE;
+    }
+    return committed;
+}
+
+int64_t AudioCapture::FirstFrameTime(snd_pcm_sframes_t avail) {
+    // The driver's stamp is when the pointer last moved, with the frames
+    // waiting at that moment; the oldest of them is that much older
+    snd_pcm_uframes_t stampedAvail = 0;
+    snd_htimestamp_t stamp{};
+    if (m_HwTimestamps && snd_pcm_htimestamp(m_Handle, &stampedAvail, &stamp) == 0 &&
+        (stamp.tv_sec != 0 || stamp.tv_nsec != 0)) {
+        const int64_t stampNs = static_cast<int64_t>(stamp.tv_sec) * 1000000000LL + stamp.tv_nsec;
+        return stampNs - static_cast<int64_t>(stampedAvail) * 1000000000LL / m_SampleRate;
+    }
+
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    return nowNs - static_cast<int64_t>(avail) * 1000000000LL / m_SampleRate;
+}
+
+void AudioCapture::Deliver(const void* data, size_t frames, int64_t captureTimeNs) {
+    if (frames != m_PeriodSize && m_ShortReads.fetch_add(1, std::memory_order_relaxed) == 0) {
+        std::cerr << "Short read: expected " << m_PeriodSize
+                  << " frames, got " << frames << " (further ones are only counted)" << std::endl;
+    }
+
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (nowNs >= captureTimeNs) {
+        double latencyMs = (nowNs - captureTimeNs) / 1e6;
+        double avg = m_AvgLatencyMs.load(std::memory_order_relaxed);
+        m_AvgLatencyMs.store(avg == 0.0 ? latencyMs : avg * 0.95 + latencyMs * 0.05, std::memory_order_relaxed);
+    }
+
+    // Straight to the sink: nothing here waits for the render loop
+    AudioPeriod period;
+    period.data = data;
+    period.frameCount = frames;
+    period.format = Format();
+    period.captureTimeNs = captureTimeNs;
+    m_PeriodsCaptured.fetch_add(1, std::memory_order_relaxed);
+    if (m_Sink && !m_Sink(period)) {
+        m_PeriodsDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 
 } // namespace uvc2gl
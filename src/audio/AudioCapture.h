@@ -1,26 +1,46 @@
 #pragma once
 
+#include "../core/IoReactor.h"
+#include "AudioConverter.h"
 #include <alsa/asoundlib.h>
 #include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
-#include <thread>
 #include <vector>
 
 namespace uvc2gl {
 
-struct AudioFrame {
-    std::vector<int16_t> samples;  // Interleaved stereo samples
-    size_t frameCount;
-    unsigned int sampleRate;
-    unsigned int channels;
-    
-    AudioFrame() : frameCount(0), sampleRate(0), channels(0) {}
-    AudioFrame(size_t frames, unsigned int rate, unsigned int ch)
-        : samples(frames * ch), frameCount(frames), sampleRate(rate), channels(ch) {}
+// One captured period, lent to the sink for the duration of the call: the
+// samples point straight into the device's mmap buffer (or the read buffer
+// when the PCM can't map), so a sink that keeps audio must copy it. They
+// are in whatever format the device offered; AudioConverter turns them
+// into what playback takes.
+struct AudioPeriod {
+    const void* data = nullptr;        // Interleaved
+    size_t frameCount = 0;
+    AudioFormat format;
+    int64_t captureTimeNs = 0;         // CLOCK_MONOTONIC time of the first frame
+};
+
+struct AudioCaptureStats {
+    uint64_t periodsCaptured = 0;
+    uint64_t periodsDropped = 0;  // Refused by the sink (playback queue full, or unconvertible)
+    uint64_t xruns = 0;           // Capture overruns recovered from
+    uint64_t shortReads = 0;      // Periods delivered with fewer frames than negotiated
+    bool mmap = false;            // Reading from the device's mmap buffer
+    bool hardwareTimestamps = false; // Periods stamped by the driver, not on arrival
+    double avgLatencyMs = 0.0;    // First frame captured to period delivered, smoothed
 };
 
 class AudioCapture {
 public:
+    // Receives each captured period on the reactor thread, as soon as it is
+    // read; returns false if it had no room and the period was dropped
+    using PeriodSink = std::function<bool(const AudioPeriod& period)>;
+
+    // Rate and channel count are preferences: the device may settle on
+    // others, and on a sample format other than S16 (see Format())
     AudioCapture(const std::string& device = "default", 
                  unsigned int sampleRate = 48000,
                  unsigned int channels = 2,
@@ -33,12 +53,30 @@ public:
     void Start();
     void Stop();
     bool IsRunning() const { return m_Running.load(); }
+
+    // Read on a reactor shared with other devices (one is created on
+    // Start() otherwise). Set before Start().
+    void SetReactor(std::shared_ptr<IoReactor> reactor) { m_Reactor = std::move(reactor); }
     
-    // Get latest audio data (non-blocking)
-    bool GetAudioFrame(AudioFrame& frame);
+    // Where periods go; set before Start(). Without a sink they are discarded.
+    void SetSink(PeriodSink sink) { m_Sink = std::move(sink); }
+
+    AudioCaptureStats GetStats() const;
+
+    // As negotiated with the device once started (requested until then)
+    snd_pcm_uframes_t PeriodSize() const { return m_PeriodSize; }
+    unsigned int SampleRate() const { return m_SampleRate; }
+    AudioFormat Format() const { return { m_Format, m_SampleRate, m_Channels }; }
     
 private:
-    void CaptureLoop();
+    // Reactor handler for the PCM's poll descriptors
+    void OnReadable(int descriptor, uint32_t events);
+    // Hands one period to the sink straight from the mmap area (or via
+    // snd_pcm_readi); frames taken or a negative errno
+    snd_pcm_sframes_t ReadPeriod(snd_pcm_sframes_t avail);
+    // When the oldest of avail waiting frames was captured
+    int64_t FirstFrameTime(snd_pcm_sframes_t avail);
+    void Deliver(const void* data, size_t frames, int64_t captureTimeNs);
     bool InitializeALSA();
     void CleanupALSA();
     
@@ -46,17 +84,24 @@ private:
     unsigned int m_SampleRate;
     unsigned int m_Channels;
     snd_pcm_uframes_t m_PeriodSize;
+    SampleFormat m_Format = SampleFormat::S16;
     
     snd_pcm_t* m_Handle;
     std::atomic<bool> m_Running;
-    std::thread m_CaptureThread;
+    std::shared_ptr<IoReactor> m_Reactor;
+    std::vector<struct pollfd> m_PollFds;
+    std::vector<int> m_ReactorIds;
     
-    // Simple double buffer for audio data
-    AudioFrame m_BufferA;
-    AudioFrame m_BufferB;
-    AudioFrame* m_WriteBuffer;
-    AudioFrame* m_ReadBuffer;
-    std::mutex m_BufferMutex;
+    PeriodSink m_Sink;
+    bool m_Mmap = true;                // MMAP_INTERLEAVED access, else RW with m_ReadBuffer
+    bool m_HwTimestamps = false;
+    std::vector<uint8_t> m_ReadBuffer; // One period, RW access only
+
+    std::atomic<uint64_t> m_PeriodsCaptured{0};
+    std::atomic<uint64_t> m_PeriodsDropped{0};
+    std::atomic<uint64_t> m_Xruns{0};
+    std::atomic<uint64_t> m_ShortReads{0};
+    std::atomic<double> m_AvgLatencyMs{0.0};
 };
 
 } // namespace uvc2gl
@@ -0,0 +1,131 @@
+// Times AudioConverter on the capture formats it has to handle, one
+// period at a time the way the capture sink calls it, converting to the
+// playback's S16 stereo at 48 kHz:
+//   AudioConvertBench [period frames] [periods]
+// "x realtime" is seconds of audio converted per second of CPU.
+#include "AudioConverter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace uvc2gl;
+
+// A 1 kHz tone at -6 dB, a different phase per channel, in the given format
+static std::vector<uint8_t> MakeInput(const AudioFormat& format, size_t frames) {
+    const size_t count = frames * format.channels;
+    std::vector<uint8_t> data(count * SampleBytes(format.format));
+    for (size_t i = 0; i < count; ++i) {
+        const size_t frame = i / format.channels;
+        const double v = 0.5 * std::sin(2.0 * M_PI * 1000.0 * frame / format.sampleRate + (i % format.channels));
+        const int32_t s32 = static_cast<int32_t>(v * 2147483647.0);
+        switch (format.format) {
+            case SampleFormat::S16: {
+                const int16_t s = static_cast<int16_t>(s32 >> 16);
+                std::memcpy(&data[i * 2], &s, 2);
+                break;
+            }
+            case SampleFormat::S24_3:
+                data[i * 3] = static_cast<uint8_t>(s32 >> 8);
+                data[i * 3 + 1] = static_cast<uint8_t>(s32 >> 16);
+                data[i * 3 + 2] = static_cast<uint8_t>(s32 >> 24);
+                break;
+            case SampleFormat::S24: {
+                const int32_t s = s32 >> 8;
+                std::memcpy(&data[i * 4], &s, 4);
+                break;
+            }
+            case SampleFormat::S32:
+                std::memcpy(&data[i * 4], &s32, 4);
+                break;
+            case SampleFormat::F32: {
+                const float f = static_cast<float>(v);
+                std::memcpy(&data[i * 4], &f, 4);
+                break;
+            }
+        }
+    }
+    return data;
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+int main(int argc, char* argv[]) {
+    const size_t period = (argc >= 2) ? static_cast<size_t>(std::max(16, std::atoi(argv[1]))) : 1024;
+    const int periods = (argc >= 3) ? std::max(1, std::atoi(argv[2])) : 20000;
+    const unsigned int outputRate = 48000;
+    const unsigned int outputChannels = 2;
+
+    struct Path {
+        const char* name;
+        AudioFormat input;
+    };
+    const Path paths[] = {
+        { "s16 2ch 48k", { SampleFormat::S16, 48000, 2 } },  // passthrough
+        { "s24_3 2ch 48k", { SampleFormat::S24_3, 48000, 2 } },
+        { "s24 2ch 48k", { SampleFormat::S24, 48000, 2 } },
+        { "s32 2ch 48k", { SampleFormat::S32, 48000, 2 } },
+        { "f32 2ch 48k", { SampleFormat::F32, 48000, 2 } },
+        { "s16 1ch 48k", { SampleFormat::S16, 48000, 1 } },
+        { "s16 6ch 48k", { SampleFormat::S16, 48000, 6 } },
+        { "s32 8ch 48k", { SampleFormat::S32, 48000, 8 } },
+        { "s16 2ch 44.1k", { SampleFormat::S16, 44100, 2 } },
+        { "s16 2ch 96k", { SampleFormat::S16, 96000, 2 } },
+        { "s24_3 8ch 44.1k", { SampleFormat::S24_3, 44100, 8 } },
+    };
+
+    std::cout << period << "-frame periods, " << periods << " per path, to S16 " << outputChannels << "ch "
+              << outputRate / 1000 << "k" << std::endl;
+    std::cout << std::left << std::setw(18) << "input"
+              << std::right << std::setw(10) << "mean us" << std::setw(10) << "p50 us"
+              << std::setw(10) << "p99 us" << std::setw(12) << "Msamples/s"
+              << std::setw(12) << "x realtime" << std::endl;
+
+    for (const auto& path : paths) {
+        const std::vector<uint8_t> input = MakeInput(path.input, period);
+        AudioConverter converter(outputRate, outputChannels);
+        size_t outFrames = 0;
+        for (int i = 0; i < 16; ++i) {
+            converter.Convert(input.data(), path.input, period, outFrames); // warm up: allocate the buffers
+        }
+
+        // Sum the output so the work can't be optimised away
+        int64_t checksum = 0;
+        std::vector<double> latencies;
+        latencies.reserve(periods);
+        for (int i = 0; i < periods; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            const int16_t* out = converter.Convert(input.data(), path.input, period, outFrames);
+            auto end = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+            checksum += outFrames ? out[(outFrames - 1) * outputChannels] : 0;
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0.0;
+        for (double l : latencies) {
+            total += l;
+        }
+        const double mean = total / latencies.size();
+        const double periodUs = period * 1e6 / path.input.sampleRate;
+        std::cout << std::left << std::setw(18) << path.name
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << mean
+                  << std::setw(10) << Percentile(latencies, 0.50)
+                  << std::setw(10) << Percentile(latencies, 0.99)
+                  << std::setprecision(1)
+                  << std::setw(12) << (period * path.input.channels) / mean
+                  << std::setw(12) << periodUs / mean
+                  << (checksum == 0x7fffffffffffffffLL ? "!" : "") << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,268 @@
+#include "AudioConverter.h"
+#include "SincFilter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace uvc2gl {
+
+// 32 taps at the input rate, widened in proportion when decimating so the
+// lower cutoff keeps the same transition band
+static constexpr int kHalfTaps = 16;
+static constexpr unsigned int kMaxPhases = 1024;
+static constexpr unsigned int kMaxDecimation = 8;
+
+template <typename T>
+static void Reserve(std::vector<T>& buffer, size_t size) {
+    if (buffer.size() < size) {
+        buffer.resize(size);
+    }
+}
+
+// Eight partial sums, so the loop vectorises without reassociating a
+// single accumulator (which the compiler won't do for floats unasked).
+// n is always a multiple of 8.
+static float Dot(const float* a, const float* b, int n) {
+    float acc[8] = {};
+    for (int j = 0; j < n; j += 8) {
+        for (int k = 0; k < 8; ++k) {
+            acc[k] += a[j + k] * b[j + k];
+        }
+    }
+    return ((acc[0] + acc[4]) + (acc[1] + acc[5])) + ((acc[2] + acc[6]) + (acc[3] + acc[7]));
+}
+
+FixedResampler::FixedResampler(unsigned int inputRate, unsigned int outputRate, unsigned int channels)
+    : m_Channels(channels)
+    , m_Planes(channels)
+{
+    const unsigned int common = std::gcd(inputRate, outputRate);
+    m_Up = outputRate / common;
+    m_Down = inputRate / common;
+    if (m_Up > kMaxPhases || m_Down > m_Up * kMaxDecimation) {
+        throw std::runtime_error("Cannot resample " + std::to_string(inputRate) + " Hz to " +
+                                 std::to_string(outputRate) + " Hz");
+    }
+
+    // Cutoff relative to the input's Nyquist frequency
+    const double cutoff = kSincCutoff * std::min(1.0, static_cast<double>(m_Up) / m_Down);
+    m_Half = kHalfTaps * static_cast<int>((m_Down + m_Up - 1) / m_Up);
+    m_Taps = m_Half * 2;
+    m_Filter.resize(static_cast<size_t>(m_Up) * m_Taps);
+    for (unsigned int p = 0; p < m_Up; ++p) {
+        BlackmanSincTaps(cutoff, m_Half, static_cast<double>(p) / m_Up, &m_Filter[static_cast<size_t>(p) * m_Taps]);
+    }
+    Reset();
+}
+
+void FixedResampler::Reset() {
+    m_InputFrames = SincHistoryFrames(m_Half);
+    for (auto& plane : m_Planes) {
+        Reserve(plane, m_InputFrames);
+        std::fill(plane.begin(), plane.end(), 0.0f);
+    }
+    m_Index = m_InputFrames;
+    m_Phase = 0;
+}
+
+size_t FixedResampler::MaxOutput(size_t inputFrames) const {
+    return (inputFrames + m_Taps) * m_Up / m_Down + 1;
+}
+
+size_t FixedResampler::Process(const float* in, size_t frames, float* out) {
+    const unsigned int channels = m_Channels;
+    for (unsigned int c = 0; c < channels; ++c) {
+        std::vector<float>& plane = m_Planes[c];
+        Reserve(plane, m_InputFrames + frames);
+        float* dst = plane.data() + m_InputFrames;
+        for (size_t i = 0; i < frames; ++i) {
+            dst[i] = in[i * channels + c];
+        }
+    }
+    m_InputFrames += frames;
+
+    size_t produced = 0;
+    while (m_Index + m_Half < m_InputFrames) {
+        const float* taps = m_Filter.data() + static_cast<size_t>(m_Phase) * m_Taps;
+        const size_t first = m_Index - m_Half + 1;
+        for (unsigned int c = 0; c < channels; ++c) {
+            out[produced * channels + c] = Dot(taps, m_Planes[c].data() + first, m_Taps);
+        }
+        ++produced;
+        m_Phase += m_Down;
+        m_Index += m_Phase / m_Up;
+        m_Phase %= m_Up;
+    }
+
+    const size_t drop = SincSpentFrames(m_Index, m_Half, m_InputFrames);
+    for (auto& plane : m_Planes) {
+        std::memmove(plane.data(), plane.data() + drop, (m_InputFrames - drop) * sizeof(float));
+    }
+    m_InputFrames -= drop;
+    m_Index -= drop;
+    return produced;
+}
+
+AudioConverter::AudioConverter(unsigned int outputRate, unsigned int outputChannels)
+    : m_OutputRate(outputRate)
+    , m_OutputChannels(outputChannels)
+{
+}
+
+std::vector<float> AudioConverter::MixMatrix(unsigned int in, unsigned int out) {
+    std::vector<float> matrix(static_cast<size_t>(out) * in, 0.0f);
+    if (out == 2 && in > 2) {
+        // Surround to stereo in ALSA's default channel order: FL FR, RL RR,
+        // FC LFE, SL SR. Everything but the front pair at -3 dB, the LFE
+        // dropped.
+        const float k = 0.7071f;
+        for (unsigned int i = 0; i < in; ++i) {
+            if (i == 5) {
+                continue;
+            }
+            const float gain = (i < 2) ? 1.0f : k;
+            if (i == 4) {
+                matrix[0 * in + i] = gain;
+                matrix[1 * in + i] = gain;
+            } else {
+                matrix[(i % 2) * in + i] = gain;
+            }
+        }
+    } else if (in < out) {
+        // Upmixing goes to the first channels only, the front pair in every
+        // layout (mono to both); centre, LFE and rears stay silent
+        for (unsigned int o = 0; o < out; ++o) {
+            if (in == 1 && o < 2) {
+                matrix[o] = 1.0f;
+            } else if (in > 1 && o < in) {
+                matrix[o * in + o] = 1.0f;
+            }
+        }
+    } else {
+        // Otherwise fold channels onto outputs round-robin, averaged
+        for (unsigned int i = 0; i < in; ++i) {
+            matrix[(i % out) * in + i] = 1.0f;
+        }
+    }
+
+    // Rows sum to one, so a full-scale input can't clip
+    for (unsigned int o = 0; o < out; ++o) {
+        float sum = 0.0f;
+        for (unsigned int i = 0; i < in; ++i) {
+            sum += matrix[o * in + i];
+        }
+        for (unsigned int i = 0; i < in && sum > 0.0f; ++i) {
+            matrix[o * in + i] /= sum;
+        }
+    }
+    return matrix;
+}
+
+static AudioConverter::MixFn SelectMixKernel(unsigned int in, unsigned int out) {
+    if (out == 2) {
+        switch (in) {
+            case 1: return MixChannels<1, 2>;
+            case 4: return MixChannels<4, 2>;
+            case 6: return MixChannels<6, 2>;
+            case 8: return MixChannels<8, 2>;
+        }
+    } else if (out == 1) {
+        switch (in) {
+            case 2: return MixChannels<2, 1>;
+            case 6: return MixChannels<6, 1>;
+            case 8: return MixChannels<8, 1>;
+        }
+    }
+    return nullptr;
+}
+
+void AudioConverter::Configure(const AudioFormat& input) {
+    m_Input = input;
+    m_Configured = true;
+    m_Passthrough = input.format == SampleFormat::S16 && input.sampleRate == m_OutputRate &&
+                    input.channels == m_OutputChannels;
+    m_Unsupported = false;
+    m_Resampler.reset();
+    m_Matrix.clear();
+    m_MixKernel = nullptr;
+    if (m_Passthrough) {
+        return;
+    }
+
+    if (input.channels != m_OutputChannels) {
+        m_Matrix = MixMatrix(input.channels, m_OutputChannels);
+        m_MixKernel = SelectMixKernel(input.channels, m_OutputChannels);
+    }
+    // Filter whichever side of the mix has fewer channels
+    m_MixFirst = m_OutputChannels < input.channels;
+    m_ResampleChannels = std::min(input.channels, m_OutputChannels);
+    if (input.sampleRate != m_OutputRate) {
+        try {
+            m_Resampler = std::make_unique<FixedResampler>(input.sampleRate, m_OutputRate, m_ResampleChannels);
+        } catch (const std::exception& e) {
+            std::cerr << "Audio conversion: " << e.what() << ", dropping audio" << std::endl;
+            m_Unsupported = true;
+            return;
+        }
+    }
+
+    std::cout << "Audio conversion: " << SampleFormatName(input.format) << " " << input.channels << " ch "
+              << input.sampleRate << " Hz to S16_LE " << m_OutputChannels << " ch " << m_OutputRate << " Hz"
+              << std::endl;
+}
+
+void AudioConverter::Mix(const float* src, float* dst, size_t frames) const {
+    if (m_MixKernel) {
+        m_MixKernel(src, dst, m_Matrix.data(), frames);
+    } else {
+        MixChannels(src, m_Input.channels, dst, m_OutputChannels, m_Matrix.data(), frames);
+    }
+}
+
+const int16_t* AudioConverter::Convert(const void* src, const AudioFormat& input, size_t frames, size_t& outFrames) {
+    if (!m_Configured || !(input == m_Input)) {
+        Configure(input);
+    }
+    if (m_Passthrough) {
+        outFrames = frames;
+        return static_cast<const int16_t*>(src);
+    }
+    if (m_Unsupported) {
+        outFrames = 0;
+        return nullptr;
+    }
+
+    Reserve(m_Float, frames * input.channels);
+    ToFloat(input.format, src, m_Float.data(), frames * input.channels);
+    const float* stage = m_Float.data();
+    unsigned int channels = input.channels;
+    size_t count = frames;
+
+    if (channels != m_OutputChannels && (m_MixFirst || !m_Resampler)) {
+        Reserve(m_Mixed, count * m_OutputChannels);
+        Mix(stage, m_Mixed.data(), count);
+        stage = m_Mixed.data();
+        channels = m_OutputChannels;
+    }
+    if (m_Resampler) {
+        Reserve(m_Resampled, m_Resampler->MaxOutput(count) * channels);
+        count = m_Resampler->Process(stage, count, m_Resampled.data());
+        stage = m_Resampled.data();
+    }
+    if (channels != m_OutputChannels) {
+        Reserve(m_Mixed, count * m_OutputChannels);
+        Mix(stage, m_Mixed.data(), count);
+        stage = m_Mixed.data();
+    }
+
+    Reserve(m_Output, count * m_OutputChannels);
+    FloatToS16(stage, m_Output.data(), count * m_OutputChannels);
+    outFrames = count;
+    return m_Output.data();
+}
+
+} // namespace uvc2gl
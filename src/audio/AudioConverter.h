@@ -0,0 +1,99 @@
+#pragma once
+
+#include "SampleKernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace uvc2gl {
+
+struct AudioFormat {
+    SampleFormat format = SampleFormat::S16;
+    unsigned int sampleRate = 48000;
+    unsigned int channels = 2;
+
+    bool operator==(const AudioFormat&) const = default;
+};
+
+// Polyphase windowed-sinc resampler for a fixed rational ratio (44.1 kHz
+// to 48 kHz is 160/147). Every phase gets its own exact filter, unlike
+// VariableResampler's interpolated ones, and the cutoff drops below the
+// output's Nyquist when decimating. Throws if the ratio reduces to more
+// than 1024 phases or decimates by more than 8.
+class FixedResampler {
+public:
+    FixedResampler(unsigned int inputRate, unsigned int outputRate, unsigned int channels);
+
+    FixedResampler(const FixedResampler&) = delete;
+    FixedResampler& operator=(const FixedResampler&) = delete;
+
+    // Most frames one Process() call of inputFrames can produce
+    size_t MaxOutput(size_t inputFrames) const;
+
+    // Appends interleaved input and writes every output frame it completes
+    size_t Process(const float* in, size_t frames, float* out);
+
+    void Reset();
+
+private:
+    unsigned int m_Up;        // Output frames per m_Down input frames
+    unsigned int m_Down;
+    unsigned int m_Channels;
+    int m_Half;               // Taps either side of the centre
+    int m_Taps;
+    std::vector<float> m_Filter; // m_Up phases of m_Taps
+    // One plane per channel so every tap loop is a contiguous dot product
+    std::vector<std::vector<float>> m_Planes;
+    size_t m_InputFrames = 0;  // Valid in every plane
+    size_t m_Index = 0;       // Input frame the next output is centred on...
+    unsigned int m_Phase = 0; // ...plus m_Phase / m_Up of a frame
+};
+
+// Turns captured periods of any supported format, channel count and rate
+// into interleaved S16 at the playback's rate and channel count. Lives on
+// the capture thread between AudioCapture's sink and
+// AudioPlayback::QueueAudio(); it rebuilds itself if the input changes and
+// allocates only then or when periods grow.
+class AudioConverter {
+public:
+    AudioConverter(unsigned int outputRate, unsigned int outputChannels);
+
+    AudioConverter(const AudioConverter&) = delete;
+    AudioConverter& operator=(const AudioConverter&) = delete;
+
+    // Converts frames input frames. Returns src itself when it is already
+    // in the output format, otherwise a buffer valid until the next call;
+    // outFrames may differ from frames when resampling. Returns nullptr for
+    // input it can't convert (a rate the resampler refuses).
+    const int16_t* Convert(const void* src, const AudioFormat& input, size_t frames, size_t& outFrames);
+
+    using MixFn = void (*)(const float* src, float* dst, const float* matrix, size_t frames);
+
+    // Downmix/upmix gains, Out rows of In; exposed for the benchmark
+    static std::vector<float> MixMatrix(unsigned int in, unsigned int out);
+
+private:
+    void Configure(const AudioFormat& input);
+    void Mix(const float* src, float* dst, size_t frames) const;
+
+    unsigned int m_OutputRate;
+    unsigned int m_OutputChannels;
+    AudioFormat m_Input;
+    bool m_Configured = false;
+    bool m_Passthrough = false;
+    bool m_Unsupported = false; // Rate the resampler can't do: periods are dropped
+    bool m_MixFirst = false;  // Mixing down before resampling, so fewer channels are filtered
+    unsigned int m_ResampleChannels = 0;
+
+    MixFn m_MixKernel = nullptr;  // Null: no mixing, or the generic loop when m_Matrix is set
+    std::vector<float> m_Matrix;
+    std::unique_ptr<FixedResampler> m_Resampler;
+
+    std::vector<float> m_Float;   // Input as float
+    std::vector<float> m_Mixed;
+    std::vector<float> m_Resampled;
+    std::vector<int16_t> m_Output;
+};
+
+} // namespace uvc2gl
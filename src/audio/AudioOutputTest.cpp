@@ -0,0 +1,90 @@
+// Plays a 1 kHz tone through a playback backend, fed in 1024-frame periods
+// the way AudioCapture feeds it, and prints the latency figures once a second.
+// With ALSA's "null" or "file" plugins it runs without any sound hardware:
+//   AudioOutputTest [sdl|alsa] [device] [seconds] [drift ppm]
+//   AudioOutputTest alsa null 10
+//   AudioOutputTest alsa 'file:FILE=/tmp/out.raw,FORMAT=raw' 5 200
+#include "AudioPlayback.h"
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace uvc2gl;
+
+int main(int argc, char* argv[]) {
+    const std::string backend = (argc >= 2) ? argv[1] : "alsa";
+    const std::string device = (argc >= 3) ? argv[2] : "null";
+    const int seconds = (argc >= 4) ? std::max(1, std::atoi(argv[3])) : 5;
+    const double driftPpm = (argc >= 5) ? std::atof(argv[4]) : 0.0;
+    const size_t period = 1024;
+
+    if (backend == "sdl" && SDL_Init(SDL_INIT_AUDIO) != 0) {
+        std::cerr << "SDL_Init failed: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<AudioPlayback> playback;
+    try {
+        playback = AudioPlayback::Create(backend, device, 48000, 2);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    // Whatever the device opened at, which is what QueueAudio() takes
+    const unsigned int rate = playback->SampleRate();
+    const unsigned int channels = playback->Channels();
+    playback->Start();
+
+    // Stands in for the capture card: one period every period/rate seconds
+    // of a clock running driftPpm fast
+    std::atomic<bool> running{true};
+    std::thread producer([&] {
+        std::vector<int16_t> block(period * channels);
+        double phase = 0.0;
+        const double step = 2.0 * M_PI * 1000.0 / rate;
+        const auto interval = std::chrono::duration<double>(period / (rate * (1.0 + driftPpm * 1e-6)));
+        auto next = std::chrono::steady_clock::now();
+        while (running.load()) {
+            for (size_t i = 0; i < period; ++i) {
+                const int16_t sample = static_cast<int16_t>(8000.0 * std::sin(phase));
+                phase = std::fmod(phase + step, 2.0 * M_PI);
+                for (unsigned int c = 0; c < channels; ++c) {
+                    block[i * channels + c] = sample;
+                }
+            }
+            playback->QueueAudio(block.data(), period);
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval);
+            std::this_thread::sleep_until(next);
+        }
+    });
+
+    std::printf("%4s %10s %10s %12s %10s %9s %9s %7s\n",
+                "t", "latency", "target", "output", "drift", "underrun", "devxrun", "resync");
+    for (int t = 1; t <= seconds; ++t) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        PlaybackStats s = playback->GetStats();
+        std::printf("%4d %7.1f ms %7.1f ms %7.1f ms %s %+7.0f ppm %9llu %9llu %7llu\n",
+                    t, s.latencyMs, s.targetMs, s.outputDelayMs, s.outputDelayMeasured ? "(m)" : "(e)",
+                    s.driftPpm, static_cast<unsigned long long>(s.underruns),
+                    static_cast<unsigned long long>(s.deviceXruns), static_cast<unsigned long long>(s.resyncs));
+    }
+
+    running = false;
+    producer.join();
+    playback->Stop();
+    playback.reset();
+    if (backend == "sdl") {
+        SDL_Quit();
+    }
+    return 0;
+}
@@ -1,128 +1,218 @@
 #include "AudioPlayback.h"
-#include <iostream>
+#include "AlsaAudioPlayback.h"
+#include "SampleKernels.h"
+#include "SdlAudioPlayback.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <cstring>
+#include <iostream>
+#include <stdexcept>
 
 namespace uvc2gl {
 
+// Sync delay changes larger than this are applied in one step
+static constexpr double kSyncStepMs = 5.0;
+
 AudioPlayback::AudioPlayback(unsigned int sampleRate, unsigned int channels)
-    : m_DeviceID(0)
-    , m_Running(false)
-    , m_ReadPos(0)
-    , m_WritePos(0)
-    , m_BufferSize(sampleRate * channels * 2) // 2 seconds of audio
-    , m_Volume(1.0f)
+    : m_SampleRate(sampleRate)
+    , m_Channels(channels)
+    , m_Ring(sampleRate * channels * 2) // 2 seconds of audio, rounded up to a power of two
 {
-    m_Buffer.resize(m_BufferSize);
-    
-    // Get current audio driver
-    const char* driver = SDL_GetCurrentAudioDriver();
-    if (driver) {
-        std::cout << "SDL Audio Driver: " << driver << std::endl;
-    }
-    
-    SDL_AudioSpec desired;
-    SDL_zero(desired);
-    desired.freq = sampleRate;
-    desired.format = AUDIO_S16SYS;
-    desired.channels = channels;
-    desired.samples = 1024;
-    desired.callback = AudioCallback;
-    desired.userdata = this;
-    
-    m_DeviceID = SDL_OpenAudioDevice(nullptr, 0, &desired, &m_AudioSpec, 0); // Don't allow changes
-    if (m_DeviceID == 0) {
-        throw std::runtime_error(std::string("Failed to open audio device: ") + SDL_GetError());
+}
+
+std::unique_ptr<AudioPlayback> AudioPlayback::Create(const std::string& backend, const std::string& device,
+                                                     unsigned int sampleRate, unsigned int channels,
+                                                     size_t periodFrames) {
+    if (backend == "sdl") {
+        return std::make_unique<SdlAudioPlayback>(sampleRate, channels, periodFrames ? periodFrames : 1024);
     }
-    
-    if (m_AudioSpec.freq != sampleRate || m_AudioSpec.channels != channels) {
-        std::cerr << "Warning: Audio format changed by SDL. Requested: " << sampleRate 
-                  << "Hz " << channels << "ch, Got: " << m_AudioSpec.freq 
-                  << "Hz " << (int)m_AudioSpec.channels << "ch" << std::endl;
+    if (backend == "alsa") {
+        return std::make_unique<AlsaAudioPlayback>(device, sampleRate, channels, periodFrames ? periodFrames : 256);
     }
-    
-    std::cout << "Audio playback initialized: " << m_AudioSpec.freq << "Hz, " 
-              << (int)m_AudioSpec.channels << " channels, buffer size: " 
-              << m_AudioSpec.samples << " frames" << std::endl;
+    throw std::runtime_error("Unknown audio output: " + backend);
 }
 
-AudioPlayback::~AudioPlayback() {
-    Stop();
-    if (m_DeviceID != 0) {
-        SDL_CloseAudioDevice(m_DeviceID);
-    }
+std::vector<std::string> AudioPlayback::Available() {
+    return { "sdl", "alsa" };
 }
 
-void AudioPlayback::Start() {
-    if (m_Running) {
-        return;
-    }
-    
-    m_Running = true;
-    SDL_PauseAudioDevice(m_DeviceID, 0); // Unpause
-    std::cout << "Audio playback started" << std::endl;
+void AudioPlayback::ConfigureOutput(unsigned int sampleRate, unsigned int channels, size_t maxFrames) {
+    m_SampleRate = sampleRate;
+    m_Channels = channels;
+    // Render() resamples at most one device request per pass, never allocating
+    m_MaxChunk = maxFrames;
+    m_Resampler = std::make_unique<VariableResampler>(channels, m_MaxChunk);
+    m_Drift = std::make_unique<DriftController>(sampleRate);
+    m_Staging.resize((m_MaxChunk * 2 + 64) * channels);
+    m_Mix.resize(m_MaxChunk * channels);
 }
 
-void AudioPlayback::Stop() {
-    if (!m_Running) {
-        return;
+bool AudioPlayback::QueueAudio(const int16_t* samples, size_t frameCount) {
+    const size_t sampleCount = frameCount * m_Channels;
+    // The consumer only ever frees space, so if it fits now it still fits
+    if (m_Ring.Capacity() - m_Ring.Size() < sampleCount) {
+        m_Overruns.fetch_add(1, std::memory_order_relaxed);
+        m_DroppedFrames.fetch_add(frameCount, std::memory_order_relaxed);
+        return false;
     }
-    
-    m_Running = false;
-    SDL_PauseAudioDevice(m_DeviceID, 1); // Pause
-    std::cout << "Audio playback stopped" << std::endl;
+    m_Ring.Write(samples, sampleCount);
+    m_LastQueueFrames.store(frameCount, std::memory_order_relaxed);
+    m_LastQueueNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+    return true;
 }
 
-void AudioPlayback::QueueAudio(const int16_t* samples, size_t frameCount) {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    
-    size_t sampleCount = frameCount * m_AudioSpec.channels;
-    
-    for (size_t i = 0; i < sampleCount; ++i) {
-        m_Buffer[m_WritePos] = samples[i];
-        m_WritePos = (m_WritePos + 1) % m_BufferSize;
-        
-        // If buffer is full, overwrite oldest data
-        if (m_WritePos == m_ReadPos) {
-            m_ReadPos = (m_ReadPos + 1) % m_BufferSize;
+void AudioPlayback::Render(int16_t* stream, size_t frames) {
+    const unsigned int channels = m_Channels;
+    const double rate = m_SampleRate;
+    const double period = static_cast<double>(m_LastQueueFrames.load(std::memory_order_relaxed));
+    // Below a period plus a device request (and the filter's reach) every
+    // request would underrun; the sync delay comes on top
+    const double syncFrames = m_SyncDelayMs.load(std::memory_order_relaxed) * rate / 1000.0;
+    const double target = std::max(m_TargetLatencyMs.load(std::memory_order_relaxed) * rate / 1000.0,
+                                   period + m_MaxChunk + 64.0) + syncFrames;
+    m_Drift->SetTarget(target);
+    m_EffectiveTargetMs.store(target * 1000.0 / rate, std::memory_order_relaxed);
+
+    double fill = m_Ring.Size() / channels + m_Resampler->BufferedFrames();
+    if (!m_Primed) {
+        // Build up to the target before playing, or the first period would underrun
+        if (fill < target) {
+            std::memset(stream, 0, frames * channels * sizeof(int16_t));
+            m_SilentFrames.fetch_add(frames, std::memory_order_relaxed);
+            return;
         }
+        m_Primed = true;
+        m_AppliedSyncFrames = syncFrames; // primed to a target that includes it
+    }
+
+    // The sync delay moves in steps (device switch, A/V sync reset, the
+    // offset slider). Slewing 100 ms at the drift loop's 2000 ppm would take
+    // most of a minute, so apply the step at once, like a resync: silence
+    // to hold audio back further, a skip to bring it forward. The drift
+    // loop only sees the residual.
+    const double syncStep = syncFrames - m_AppliedSyncFrames;
+    if (std::abs(syncStep) > kSyncStepMs * rate / 1000.0) {
+        if (syncStep > 0.0) {
+            m_PadFrames += static_cast<size_t>(syncStep);
+        } else {
+            size_t drop = static_cast<size_t>(-syncStep);
+            const size_t unpadded = std::min(drop, m_PadFrames);
+            m_PadFrames -= unpadded;
+            drop = std::min(drop - unpadded, m_Ring.Size() / channels);
+            m_Ring.Skip(drop * channels);
+        }
+        m_Drift->ResetSmoothing();
+        fill = m_Ring.Size() / channels + m_Resampler->BufferedFrames();
+    }
+    m_AppliedSyncFrames = syncFrames;
+
+    // A backlog far past the target (start-up burst, stalled output) would
+    // take minutes to drain at a few hundred ppm, so cut it back at once
+    if (fill > 3.0 * target + frames) {
+        size_t excess = static_cast<size_t>(fill - target);
+        m_Ring.Skip(excess * channels);
+        m_Resyncs.fetch_add(1, std::memory_order_relaxed);
+        m_Drift->ResetSmoothing();
+        fill = m_Ring.Size() / channels + m_Resampler->BufferedFrames();
+    }
+
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const double sinceQueue = (nowNs - m_LastQueueNs.load(std::memory_order_relaxed)) * rate / 1e9;
+    // Silence still to be padded in counts as queued: the step has been taken
+    const double ratio = m_Drift->Update(fill + m_PadFrames + std::clamp(sinceQueue, 0.0, period), frames / rate);
+    const float volume = m_Volume.load(std::memory_order_relaxed);
+    if (m_Gain < 0.0f) {
+        m_Gain = volume;
     }
+
+    size_t done = 0;
+    if (m_PadFrames > 0) {
+        done = std::min(frames, m_PadFrames);
+        std::memset(stream, 0, done * channels * sizeof(int16_t));
+        m_SilentFrames.fetch_add(done, std::memory_order_relaxed);
+        m_PadFrames -= done;
+    }
+    while (done < frames) {
+        const size_t chunk = std::min(frames - done, m_MaxChunk);
+
+        // Pull just enough input for this pass out of the ring
+        size_t needed = std::min(m_Resampler->InputNeeded(chunk, ratio), m_Staging.size() / channels);
+        if (needed > 0) {
+            float* input = m_Resampler->InputSpace(needed);
+            size_t got = m_Ring.Read(m_Staging.data(), needed * channels) / channels;
+            for (size_t i = 0; i < got * channels; ++i) {
+                input[i] = m_Staging[i];
+            }
+            m_Resampler->Commit(got);
+        }
+
+        size_t produced = m_Resampler->Process(m_Mix.data(), chunk, ratio);
+        // Apply volume while converting back, saturating to int16_t range.
+        // A change ramps over the block rather than stepping, which would
+        // be heard as zipper noise while the slider moves.
+        ApplyGain(m_Mix.data(), stream + done * channels, produced, channels,
+                  m_Gain, GainRampStep(m_Gain, volume, produced));
+        if (produced > 0) {
+            m_Gain = volume;
+        }
+        done += produced;
+
+        if (produced < chunk) {
+            // No data available, output silence and wait for the target again
+            std::memset(stream + done * channels, 0, (frames - done) * channels * sizeof(int16_t));
+            m_SilentFrames.fetch_add(frames - done, std::memory_order_relaxed);
+            m_Underruns.fetch_add(1, std::memory_order_relaxed);
+            m_Primed = false;
+            m_PadFrames = 0; // priming fills to the whole target again
+            break;
+        }
+    }
+
+    const double deviceFrames = m_OutputDelayFrames.load(std::memory_order_relaxed);
+    m_LatencyMs.store((m_Drift->SmoothedFill() + deviceFrames) * 1000.0 / rate, std::memory_order_relaxed);
+    m_DriftPpm.store(m_Drift->DriftPpm(), std::memory_order_relaxed);
 }
 
-void AudioPlayback::AudioCallback(void* userdata, uint8_t* stream, int len) {
-    AudioPlayback* self = static_cast<AudioPlayback*>(userdata);
-    int16_t* output = reinterpret_cast<int16_t*>(stream);
-    int frameCount = len / (sizeof(int16_t) * self->m_AudioSpec.channels);
-    
-    self->FillAudioBuffer(output, frameCount);
+PlaybackStats AudioPlayback::GetStats() const {
+    PlaybackStats stats;
+    stats.queuedFrames = m_Ring.Size() / m_Channels;
+    stats.capacityFrames = m_Ring.Capacity() / m_Channels;
+    stats.underruns = m_Underruns.load(std::memory_order_relaxed);
+    stats.overruns = m_Overruns.load(std::memory_order_relaxed);
+    stats.droppedFrames = m_DroppedFrames.load(std::memory_order_relaxed);
+    stats.resyncs = m_Resyncs.load(std::memory_order_relaxed);
+    stats.silentFrames = m_SilentFrames.load(std::memory_order_relaxed);
+    stats.latencyMs = m_LatencyMs.load(std::memory_order_relaxed);
+    stats.targetMs = m_EffectiveTargetMs.load(std::memory_order_relaxed);
+    stats.syncDelayMs = m_SyncDelayMs.load(std::memory_order_relaxed);
+    stats.driftPpm = m_DriftPpm.load(std::memory_order_relaxed);
+    stats.deviceXruns = m_DeviceXruns.load(std::memory_order_relaxed);
+    stats.outputDelayMs = m_OutputDelayFrames.load(std::memory_order_relaxed) * 1000.0 / m_SampleRate;
+    stats.outputDelayMeasured = m_OutputDelayMeasured.load(std::memory_order_relaxed);
+    return stats;
 }
 
-void AudioPlayback::FillAudioBuffer(int16_t* stream, int frameCount) {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    
-    size_t sampleCount = frameCount * m_AudioSpec.channels;
-    size_t samplesRead = 0;
-    
-    for (size_t i = 0; i < sampleCount; ++i) {
-        if (m_ReadPos != m_WritePos) {
-            // Apply volume by scaling the sample
-            int32_t sample = static_cast<int32_t>(m_Buffer[m_ReadPos]);
-            sample = static_cast<int32_t>(sample * m_Volume);
-            // Clamp to int16_t range
-            if (sample > 32767) sample = 32767;
-            if (sample < -32768) sample = -32768;
-            stream[i] = static_cast<int16_t>(sample);
-            m_ReadPos = (m_ReadPos + 1) % m_BufferSize;
-            samplesRead++;
-        } else {
-            // No data available, output silence
-            stream[i] = 0;
-        }
+void AudioPlayback::SetThreadPolicy(const ThreadPolicy& policy) {
+    m_ThreadPolicy = policy;
+    m_PolicyPending.store(true, std::memory_order_release);
+}
+
+void AudioPlayback::ApplyPendingThreadPolicy(const char* threadName) {
+    if (m_PolicyPending.exchange(false, std::memory_order_acquire)) {
+        ApplyThreadPolicy(threadName, m_ThreadPolicy);
     }
 }
 
+void AudioPlayback::SetOutputDelay(double frames, bool measured) {
+    m_OutputDelayFrames.store(frames, std::memory_order_relaxed);
+    m_OutputDelayMeasured.store(measured, std::memory_order_relaxed);
+}
+
 void AudioPlayback::SetVolume(float volume) {
-    std::lock_guard<std::mutex> lock(m_Mutex);
-    m_Volume = std::max(0.0f, std::min(1.0f, volume)); // Clamp between 0 and 1
+    m_Volume.store(std::max(0.0f, std::min(1.0f, volume)), std::memory_order_relaxed); // Clamp between 0 and 1
 }
 
 } // namespace uvc2gl
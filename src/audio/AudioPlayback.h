@@ -1,46 +1,152 @@
 #pragma once
 
-#include <SDL2/SDL.h>
-#include <vector>
-#include <mutex>
+#include "../core/ThreadPolicy.h"
+#include "DriftResampler.h"
+#include "SpscRing.h"
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace uvc2gl {
 
+struct PlaybackStats {
+    size_t queuedFrames = 0;    // Waiting in the ring
+    size_t capacityFrames = 0;
+    uint64_t underruns = 0;     // Times the output ran out of samples
+    uint64_t overruns = 0;      // QueueAudio blocks that didn't fit
+    uint64_t droppedFrames = 0; // Frames those overruns discarded
+    uint64_t resyncs = 0;       // Times the backlog was cut back to the target at once
+    uint64_t silentFrames = 0;  // Frames of silence played while priming or after an underrun
+    uint64_t deviceXruns = 0;   // Underruns the output device itself reported (ALSA only)
+    double latencyMs = 0.0;     // Queued audio plus the output delay, smoothed
+    double targetMs = 0.0;      // Effective target (raised to what the period sizes allow) plus the sync delay
+    double syncDelayMs = 0.0;   // Part of the target holding audio back for A/V sync
+    double driftPpm = 0.0;      // Capture clock relative to the output clock
+    double outputDelayMs = 0.0; // Queued in the device: measured by ALSA, SDL's buffer size otherwise
+    bool outputDelayMeasured = false;
+
+    double FillPercent() const { return capacityFrames ? 100.0 * queuedFrames / capacityFrames : 0.0; }
+};
+
+// Playback through one of several output backends. The base class owns
+// the queue from the capture side, the drift compensation and the stats;
+// a backend opens its device and calls Render() whenever the device wants
+// more samples.
 class AudioPlayback {
 public:
-    AudioPlayback(unsigned int sampleRate = 48000, unsigned int channels = 2);
-    ~AudioPlayback();
+    virtual ~AudioPlayback() = default;
     
     AudioPlayback(const AudioPlayback&) = delete;
     AudioPlayback& operator=(const AudioPlayback&) = delete;
+
+    virtual const char* Name() const = 0;
     
-    void Start();
-    void Stop();
-    bool IsRunning() const { return m_Running; }
+    virtual void Start() = 0;
+    virtual void Stop() = 0;
+    bool IsRunning() const { return m_Running.load(); }
     
-    // Queue audio samples for playback (called from main thread)
-    void QueueAudio(const int16_t* samples, size_t frameCount);
+    // Queue audio samples for playback. Single producer: only one thread
+    // may call this (the capture thread). A block that doesn't fit whole is
+    // dropped and false returned, so periods are never cut in half.
+    bool QueueAudio(const int16_t* samples, size_t frameCount);
     
     // Volume control (0.0 to 1.0)
     void SetVolume(float volume);
-    float GetVolume() const { return m_Volume; }
+    float GetVolume() const { return m_Volume.load(std::memory_order_relaxed); }
+
+    PlaybackStats GetStats() const;
+
+    // Queue fill the drift controller steers towards. It can't usefully be
+    // below one capture period plus one device buffer and is raised to that.
+    void SetTargetLatency(double milliseconds) { m_TargetLatencyMs.store(milliseconds, std::memory_order_relaxed); }
+
+    // Extra queue depth to hold audio back behind slower video. A change of
+    // more than a few ms takes effect at once (silence or a skip); smaller
+    // ones are left to the drift controller to slew to silently
+    void SetSyncDelay(double milliseconds) { m_SyncDelayMs.store(milliseconds, std::memory_order_relaxed); }
+
+    // Applied to the output thread when it next runs; set before Start()
+    void SetThreadPolicy(const ThreadPolicy& policy);
+
+    // Frames the device asks for at a time (SDL buffer or ALSA period)
+    size_t DeviceFrames() const { return m_MaxChunk; }
+
+    // What the device opened at, which may not be what was asked for;
+    // QueueAudio() takes S16 at exactly this rate and channel count
+    unsigned int SampleRate() const { return m_SampleRate; }
+    unsigned int Channels() const { return m_Channels; }
+
+    // "sdl" or "alsa"; device is the ALSA PCM name (SDL plays to its
+    // default output). periodFrames 0 keeps the backend's default. Throws
+    // if the backend is unknown or fails to open.
+    static std::unique_ptr<AudioPlayback> Create(const std::string& backend,
+                                                 const std::string& device = "default",
+                                                 unsigned int sampleRate = 48000,
+                                                 unsigned int channels = 2,
+                                                 size_t periodFrames = 0);
+    static std::vector<std::string> Available();
+
+protected:
+    AudioPlayback(unsigned int sampleRate, unsigned int channels);
+
+    // Once the device is open: the format it runs at and the most frames a
+    // single Render() call will be asked for
+    void ConfigureOutput(unsigned int sampleRate, unsigned int channels, size_t maxFrames);
+
+    // Output thread only: fills frames interleaved frames with the queued
+    // audio, resampled onto the output clock, or silence if there is none
+    void Render(int16_t* out, size_t frames);
+
+    // Audio written but not yet heard on the device side, in frames
+    void SetOutputDelay(double frames, bool measured);
+
+    // Output thread only: applies a policy set since the last call
+    void ApplyPendingThreadPolicy(const char* threadName);
+
+    std::atomic<bool> m_Running{false};
+    std::atomic<uint64_t> m_DeviceXruns{0};
     
 private:
-    static void AudioCallback(void* userdata, uint8_t* stream, int len);
-    void FillAudioBuffer(int16_t* stream, int frameCount);
-    
-    SDL_AudioDeviceID m_DeviceID;
-    SDL_AudioSpec m_AudioSpec;
-    bool m_Running;
-    
-    // Ring buffer for audio samples
-    std::vector<int16_t> m_Buffer;
-    size_t m_ReadPos;
-    size_t m_WritePos;
-    size_t m_BufferSize;
-    std::mutex m_Mutex;
-    float m_Volume;
+    unsigned int m_SampleRate;
+    unsigned int m_Channels;
+
+    // Interleaved samples; the output thread never blocks on the producer
+    SpscRing<int16_t> m_Ring;
+    std::atomic<float> m_Volume{1.0f};
+    std::atomic<double> m_TargetLatencyMs{50.0};
+    std::atomic<double> m_SyncDelayMs{0.0};
+    // When the last block was queued and its size: frames the capture card
+    // has buffered since then count towards the fill, which takes the
+    // period sawtooth out of the controller's input
+    std::atomic<int64_t> m_LastQueueNs{0};
+    std::atomic<size_t> m_LastQueueFrames{0};
+
+    // Output thread only: resampling between the capture and output clocks
+    std::unique_ptr<VariableResampler> m_Resampler;
+    std::unique_ptr<DriftController> m_Drift;
+    std::vector<int16_t> m_Staging;     // Ring samples on their way to the resampler
+    std::vector<float> m_Mix;           // Resampler output before volume and clamping
+    float m_Gain = -1.0f;               // Volume the last block ended on; negative before the first
+    size_t m_MaxChunk = 0;              // Frames per resampler pass
+    bool m_Primed = false;              // Queue has reached the target since the last underrun
+    double m_AppliedSyncFrames = 0.0;   // Sync delay as of the last Render(); bigger changes are stepped
+    size_t m_PadFrames = 0;             // Silence still to play for a sync delay increase
+
+    std::atomic<uint64_t> m_Underruns{0};
+    std::atomic<uint64_t> m_Overruns{0};
+    std::atomic<uint64_t> m_DroppedFrames{0};
+    std::atomic<uint64_t> m_Resyncs{0};
+    std::atomic<uint64_t> m_SilentFrames{0};
+    std::atomic<double> m_LatencyMs{0.0};
+    std::atomic<double> m_DriftPpm{0.0};
+    std::atomic<double> m_EffectiveTargetMs{0.0};
+    std::atomic<double> m_OutputDelayFrames{0.0};
+    std::atomic<bool> m_OutputDelayMeasured{false};
+
+    ThreadPolicy m_ThreadPolicy;        // Published to the output thread by m_PolicyPending
+    std::atomic<bool> m_PolicyPending{false};
 };
 
 } // namespace uvc2gl
@@ -0,0 +1,118 @@
+#include "DriftResampler.h"
+#include "SincFilter.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace uvc2gl {
+
+// 32-tap filter, 128 phases with linear interpolation between them. The
+// ratio stays within a fraction of a percent of 1, so kSincCutoff is
+// enough.
+static constexpr int kTaps = 32;
+static constexpr int kHalf = kTaps / 2;
+static constexpr int kPhases = 128;
+
+// Loop gains (per second of fill error) and the largest correction the
+// controller may apply; 2000 ppm is well under audible pitch change
+static constexpr double kProportional = 0.05;
+static constexpr double kIntegral = 0.005;
+static constexpr double kMaxAdjust = 0.002;
+
+using FilterTable = std::array<float, (kPhases + 1) * kTaps>;
+
+static const FilterTable& Coefficients() {
+    static const FilterTable table = [] {
+        FilterTable t{};
+        for (int p = 0; p <= kPhases; ++p) {
+            BlackmanSincTaps(kSincCutoff, kHalf, static_cast<double>(p) / kPhases, &t[p * kTaps]);
+        }
+        return t;
+    }();
+    return table;
+}
+
+VariableResampler::VariableResampler(unsigned int channels, size_t maxOutputFrames)
+    : m_Channels(channels)
+    , m_Input((maxOutputFrames * 2 + kTaps * 2) * channels)
+{
+    Coefficients();
+    Reset();
+}
+
+void VariableResampler::Reset() {
+    std::fill(m_Input.begin(), m_Input.end(), 0.0f);
+    m_InputFrames = SincHistoryFrames(kHalf);
+    m_Position = static_cast<double>(m_InputFrames);
+}
+
+size_t VariableResampler::InputNeeded(size_t outFrames, double ratio) const {
+    if (outFrames == 0) {
+        return 0;
+    }
+    const double last = m_Position + (outFrames - 1) * ratio;
+    const size_t needed = static_cast<size_t>(last) + kHalf + 1;
+    return needed > m_InputFrames ? needed - m_InputFrames : 0;
+}
+
+float* VariableResampler::InputSpace(size_t& frames) {
+    frames = std::min(frames, m_Input.size() / m_Channels - m_InputFrames);
+    return m_Input.data() + m_InputFrames * m_Channels;
+}
+
+void VariableResampler::Commit(size_t frames) {
+    m_InputFrames += frames;
+}
+
+size_t VariableResampler::Process(float* out, size_t outFrames, double ratio) {
+    const FilterTable& table = Coefficients();
+    const unsigned int channels = m_Channels;
+    size_t produced = 0;
+    float taps[kTaps];
+
+    for (; produced < outFrames; ++produced) {
+        const size_t ip = static_cast<size_t>(m_Position);
+        if (ip + kHalf >= m_InputFrames) {
+            break; // out of input
+        }
+        const double phase = (m_Position - ip) * kPhases;
+        const int p0 = static_cast<int>(phase);
+        const float blend = static_cast<float>(phase - p0);
+        const float* c0 = &table[p0 * kTaps];
+        const float* c1 = c0 + kTaps;
+        for (int j = 0; j < kTaps; ++j) {
+            taps[j] = c0[j] + (c1[j] - c0[j]) * blend;
+        }
+
+        const float* src = m_Input.data() + (ip - kHalf + 1) * channels;
+        for (unsigned int c = 0; c < channels; ++c) {
+            float acc = 0.0f;
+            for (int j = 0; j < kTaps; ++j) {
+                acc += taps[j] * src[j * channels + c];
+            }
+            out[produced * channels + c] = acc;
+        }
+        m_Position += ratio;
+    }
+
+    const size_t drop = SincSpentFrames(static_cast<size_t>(m_Position), kHalf, m_InputFrames);
+    std::memmove(m_Input.data(), m_Input.data() + drop * channels,
+                 (m_InputFrames - drop) * channels * sizeof(float));
+    m_InputFrames -= drop;
+    m_Position -= drop;
+    return produced;
+}
+
+double VariableResampler::BufferedFrames() const {
+    return std::max(0.0, m_InputFrames - m_Position);
+}
+
+double DriftController::Update(double fillFrames, double seconds) {
+    m_SmoothedFill = (m_SmoothedFill < 0.0) ? fillFrames : m_SmoothedFill * 0.95 + fillFrames * 0.05;
+    const double error = (m_SmoothedFill - m_Target) / m_SampleRate; // seconds of audio
+    m_Integral = std::clamp(m_Integral + kIntegral * error * seconds, -kMaxAdjust, kMaxAdjust);
+    return 1.0 + std::clamp(kProportional * error + m_Integral, -kMaxAdjust, kMaxAdjust);
+}
+
+} // namespace uvc2gl
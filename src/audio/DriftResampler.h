@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace uvc2gl {
+
+// Windowed-sinc interpolator whose ratio may change on every call, for
+// pulling capture audio at a rate that tracks the output device's clock.
+// Input is appended as float frames; the filter keeps its own history so
+// consecutive calls join without clicks.
+class VariableResampler {
+public:
+    // maxOutputFrames bounds a single Process() call
+    VariableResampler(unsigned int channels, size_t maxOutputFrames);
+
+    VariableResampler(const VariableResampler&) = delete;
+    VariableResampler& operator=(const VariableResampler&) = delete;
+
+    // Input frames still missing for Process(outFrames, ratio)
+    size_t InputNeeded(size_t outFrames, double ratio) const;
+
+    // Room for up to frames interleaved input frames; fill some of it and
+    // Commit() how many were written
+    float* InputSpace(size_t& frames);
+    void Commit(size_t frames);
+
+    // Writes up to outFrames interleaved frames, stepping ratio input frames
+    // per output frame; returns fewer if it runs out of input
+    size_t Process(float* out, size_t outFrames, double ratio);
+
+    // Input frames appended but not yet played out (part of the latency)
+    double BufferedFrames() const;
+
+    void Reset();
+
+private:
+    unsigned int m_Channels;
+    std::vector<float> m_Input;  // Interleaved, m_InputFrames valid
+    size_t m_InputFrames = 0;
+    double m_Position = 0.0;     // Input frame the next output is centred on
+};
+
+// Keeps the playback queue near a target fill by nudging the resampling
+// ratio: a PI loop on the smoothed fill error, whose integral settles on
+// the clock drift between the capture card and the output device.
+class DriftController {
+public:
+    explicit DriftController(double sampleRate) : m_SampleRate(sampleRate) {}
+
+    void SetTarget(double frames) { m_Target = frames; }
+    double Target() const { return m_Target; }
+
+    // Called once per output callback with the current fill (frames) and
+    // the callback's duration; returns input frames per output frame
+    double Update(double fillFrames, double seconds);
+
+    // After a hard resync the fill jumps; don't let the jump into the loop
+    void ResetSmoothing() { m_SmoothedFill = -1.0; }
+
+    double SmoothedFill() const { return m_SmoothedFill < 0.0 ? 0.0 : m_SmoothedFill; }
+    double DriftPpm() const { return m_Integral * 1e6; }
+
+private:
+    double m_SampleRate;
+    double m_Target = 0.0;
+    double m_SmoothedFill = -1.0;
+    double m_Integral = 0.0;
+};
+
+} // namespace uvc2gl
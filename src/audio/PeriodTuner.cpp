@@ -0,0 +1,39 @@
+#include "PeriodTuner.h"
+#include <algorithm>
+
+namespace uvc2gl {
+
+// Two xruns within this long means the period is too short. A single one
+// is tolerated: suspend/resume or a device switch can cause it on its own.
+static constexpr auto kWindow = std::chrono::seconds(10);
+static constexpr uint64_t kXrunsToBackOff = 2;
+static constexpr auto kSettleTime = std::chrono::seconds(1);
+
+PeriodTuner::PeriodTuner(size_t initialFrames, Clock::time_point now)
+    : m_Frames(std::clamp(initialFrames, kMinFrames, kMaxFrames))
+    , m_Started(now)
+{
+}
+
+bool PeriodTuner::Update(uint64_t xruns, Clock::time_point now) {
+    if (now - m_Started < kSettleTime) {
+        return false;
+    }
+    if (!m_Counting || now - m_WindowStart > kWindow) {
+        m_Counting = true;
+        m_Baseline = xruns;
+        m_WindowStart = now;
+        return false;
+    }
+    if (xruns < m_Baseline + kXrunsToBackOff || m_Frames >= kMaxFrames) {
+        return false;
+    }
+
+    m_Frames = std::min(m_Frames * 2, kMaxFrames);
+    // The reopened device's counter starts from zero again
+    m_Started = now;
+    m_Counting = false;
+    return true;
+}
+
+} // namespace uvc2gl
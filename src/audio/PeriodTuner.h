@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace uvc2gl {
+
+// Picks the period size for one ALSA device. It starts small and doubles
+// whenever xruns show the period is too short to keep up with, so it
+// settles on the smallest size that runs clean. It never shrinks within a
+// session; the settled size is what gets remembered for the device.
+class PeriodTuner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kDefaultFrames = 256;
+    static constexpr size_t kMinFrames = 64;
+    static constexpr size_t kMaxFrames = 4096;
+
+    explicit PeriodTuner(size_t initialFrames = kDefaultFrames, Clock::time_point now = Clock::now());
+
+    size_t Frames() const { return m_Frames; }
+
+    // Fed the device's running xrun count, periodically. Returns true when
+    // the period has just been doubled; the caller then reopens the device
+    // with Frames(). The tuner restarts its settle time itself, so it can
+    // keep being fed - or be replaced by one built with the new size.
+    bool Update(uint64_t xruns, Clock::time_point now = Clock::now());
+
+private:
+    size_t m_Frames;
+    Clock::time_point m_Started;     // Xruns while the device settles are ignored
+    bool m_Counting = false;
+    uint64_t m_Baseline = 0;         // Xrun count at the start of the window
+    Clock::time_point m_WindowStart;
+};
+
+} // namespace uvc2gl
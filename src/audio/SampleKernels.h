@@ -0,0 +1,171 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace uvc2gl {
+
+// Capture sample formats the conversion stage reads, all little-endian
+// and interleaved. S24 is 24 bits in the low three bytes of an int32;
+// S24_3 is packed into three bytes.
+enum class SampleFormat { S16, S24_3, S24, S32, F32 };
+
+inline size_t SampleBytes(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::S16: return 2;
+        case SampleFormat::S24_3: return 3;
+        default: return 4;
+    }
+}
+
+inline const char* SampleFormatName(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::S16: return "S16_LE";
+        case SampleFormat::S24_3: return "S24_3LE";
+        case SampleFormat::S24: return "S24_LE";
+        case SampleFormat::S32: return "S32_LE";
+        case SampleFormat::F32: return "FLOAT_LE";
+    }
+    return "?";
+}
+
+// Every kernel works on count samples (not frames) and is a straight loop
+// with no branches or calls in the body, so -O3 -march=native turns it
+// into vector code. Floats are kept at int16 scale (full range is
+// +-32768) throughout, which is also what AudioPlayback resamples in.
+
+inline void S16ToFloat(const int16_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = src[i];
+    }
+}
+
+inline void S24_3ToFloat(const uint8_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // Assemble into the top three bytes so the sign comes for free
+        const uint32_t v = (static_cast<uint32_t>(src[3 * i]) << 8) |
+                           (static_cast<uint32_t>(src[3 * i + 1]) << 16) |
+                           (static_cast<uint32_t>(src[3 * i + 2]) << 24);
+        dst[i] = static_cast<float>(static_cast<int32_t>(v)) * (1.0f / 65536.0f);
+    }
+}
+
+inline void S24ToFloat(const int32_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // The top byte is padding and may hold anything
+        const int32_t v = static_cast<int32_t>(static_cast<uint32_t>(src[i]) << 8);
+        dst[i] = static_cast<float>(v) * (1.0f / 65536.0f);
+    }
+}
+
+inline void S32ToFloat(const int32_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / 65536.0f);
+    }
+}
+
+inline void F32ToFloat(const float* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = src[i] * 32768.0f;
+    }
+}
+
+inline void ToFloat(SampleFormat format, const void* src, float* dst, size_t count) {
+    switch (format) {
+        case SampleFormat::S16: S16ToFloat(static_cast<const int16_t*>(src), dst, count); break;
+        case SampleFormat::S24_3: S24_3ToFloat(static_cast<const uint8_t*>(src), dst, count); break;
+        case SampleFormat::S24: S24ToFloat(static_cast<const int32_t*>(src), dst, count); break;
+        case SampleFormat::S32: S32ToFloat(static_cast<const int32_t*>(src), dst, count); break;
+        case SampleFormat::F32: F32ToFloat(static_cast<const float*>(src), dst, count); break;
+    }
+}
+
+// Rounds to nearest, ties to even, like lrint but without the call: adding
+// and subtracting 1.5 * 2^23 leaves no fraction bits for anything in int16
+// range, in plain vector adds even on SSE2
+inline float RoundToInt16Grid(float s) {
+    return (s + 12582912.0f) - 12582912.0f;
+}
+
+// Saturates, then rounds
+inline void FloatToS16(const float* src, int16_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const float s = std::clamp(src[i], -32768.0f, 32767.0f);
+        dst[i] = static_cast<int16_t>(RoundToInt16Grid(s));
+    }
+}
+
+// Per-frame gain step for a linear ramp from one gain to another over
+// frames frames, rounded to 11 significant bits. step * frame is then exact
+// for any frame below 8192, so whether the compiler fuses the ramp's
+// multiply-add or not, every build computes the same gains.
+inline float GainRampStep(float from, float to, size_t frames) {
+    if (frames == 0 || from == to) {
+        return 0.0f;
+    }
+    int exponent = 0;
+    std::frexp((to - from) / frames, &exponent);
+    return std::ldexp(std::round(std::ldexp((to - from) / frames, 11 - exponent)), exponent - 11);
+}
+
+// FloatToS16 with a gain ramp: frame f is scaled by gain + step * f. The
+// channel loop has a fixed length so the compiler vectorises across frames.
+template <unsigned Channels>
+void ApplyGain(const float* src, int16_t* dst, size_t frames, float gain, float step) {
+    for (size_t f = 0; f < frames; ++f) {
+        const float g = gain + step * static_cast<float>(f);
+        for (unsigned c = 0; c < Channels; ++c) {
+            const float s = std::clamp(src[f * Channels + c] * g, -32768.0f, 32767.0f);
+            dst[f * Channels + c] = static_cast<int16_t>(RoundToInt16Grid(s));
+        }
+    }
+}
+
+inline void ApplyGain(const float* src, int16_t* dst, size_t frames, unsigned channels, float gain, float step) {
+    switch (channels) {
+        case 1: ApplyGain<1>(src, dst, frames, gain, step); return;
+        case 2: ApplyGain<2>(src, dst, frames, gain, step); return;
+        case 6: ApplyGain<6>(src, dst, frames, gain, step); return;
+        case 8: ApplyGain<8>(src, dst, frames, gain, step); return;
+    }
+    for (size_t f = 0; f < frames; ++f) {
+        const float g = gain + step * static_cast<float>(f);
+        for (unsigned c = 0; c < channels; ++c) {
+            const float s = std::clamp(src[f * channels + c] * g, -32768.0f, 32767.0f);
+            dst[f * channels + c] = static_cast<int16_t>(RoundToInt16Grid(s));
+        }
+    }
+}
+
+// out = matrix * in for every frame; matrix is Out rows of In gains.
+// Fixed channel counts give the compiler constant strides to vectorise
+// across frames.
+template <unsigned In, unsigned Out>
+void MixChannels(const float* src, float* dst, const float* matrix, size_t frames) {
+    for (size_t f = 0; f < frames; ++f) {
+        for (unsigned o = 0; o < Out; ++o) {
+            float acc = 0.0f;
+            for (unsigned i = 0; i < In; ++i) {
+                acc += matrix[o * In + i] * src[f * In + i];
+            }
+            dst[f * Out + o] = acc;
+        }
+    }
+}
+
+// Any other layout
+inline void MixChannels(const float* src, unsigned in, float* dst, unsigned out, const float* matrix, size_t frames) {
+    for (size_t f = 0; f < frames; ++f) {
+        for (unsigned o = 0; o < out; ++o) {
+            float acc = 0.0f;
+            for (unsigned i = 0; i < in; ++i) {
+                acc += matrix[o * in + i] * src[f * in + i];
+            }
+            dst[f * out + o] = acc;
+        }
+    }
+}
+
+} // namespace uvc2gl
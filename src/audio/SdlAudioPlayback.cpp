@@ -0,0 +1,91 @@
+#include "SdlAudioPlayback.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace uvc2gl {
+
+SdlAudioPlayback::SdlAudioPlayback(unsigned int sampleRate, unsigned int channels, size_t bufferFrames)
+    : AudioPlayback(sampleRate, channels)
+    , m_DeviceID(0)
+{
+    // Get current audio driver
+    const char* driver = SDL_GetCurrentAudioDriver();
+    if (driver) {
+        std::cout << "SDL Audio Driver: " << driver << std::endl;
+    }
+    
+    SDL_AudioSpec desired;
+    SDL_zero(desired);
+    desired.freq = sampleRate;
+    desired.format = AUDIO_S16SYS;
+    desired.channels = channels;
+    desired.samples = static_cast<Uint16>(std::min<size_t>(bufferFrames, 32768));
+    desired.callback = AudioCallback;
+    desired.userdata = this;
+    
+    // Take the device's own rate and channel count rather than have SDL
+    // convert again behind the capture side's converter; S16 stays fixed
+    m_DeviceID = SDL_OpenAudioDevice(nullptr, 0, &desired, &m_AudioSpec,
+                                     SDL_AUDIO_ALLOW_FREQUENCY_CHANGE | SDL_AUDIO_ALLOW_CHANNELS_CHANGE);
+    if (m_DeviceID == 0) {
+        throw std::runtime_error(std::string("Failed to open audio device: ") + SDL_GetError());
+    }
+    
+    if (m_AudioSpec.freq != static_cast<int>(sampleRate) || m_AudioSpec.channels != channels) {
+        std::cout << "Audio output runs at " << m_AudioSpec.freq << "Hz " << (int)m_AudioSpec.channels
+                  << "ch (asked for " << sampleRate << "Hz " << channels << "ch); capture is converted to match"
+                  << std::endl;
+    }
+    
+    std::cout << "Audio playback initialized: " << m_AudioSpec.freq << "Hz, " 
+              << (int)m_AudioSpec.channels << " channels, buffer size: " 
+              << m_AudioSpec.samples << " frames" << std::endl;
+
+    ConfigureOutput(m_AudioSpec.freq, m_AudioSpec.channels, m_AudioSpec.samples);
+    // SDL doesn't report what the sound server holds on top of this
+    SetOutputDelay(m_AudioSpec.samples, false);
+}
+
+SdlAudioPlayback::~SdlAudioPlayback() {
+    try {
+        Stop();
+    } catch (...) {
+        std::cerr << "Exception in SdlAudioPlayback destructor" << std::endl;
+    }
+    if (m_DeviceID != 0) {
+        SDL_CloseAudioDevice(m_DeviceID);
+    }
+}
+
+void SdlAudioPlayback::Start() {
+    if (m_Running) {
+        return;
+    }
+    
+    m_Running = true;
+    SDL_PauseAudioDevice(m_DeviceID, 0); // Unpause
+    std::cout << "Audio playback started" << std::endl;
+}
+
+void SdlAudioPlayback::Stop() {
+    if (!m_Running) {
+        return;
+    }
+    
+    m_Running = false;
+    SDL_PauseAudioDevice(m_DeviceID, 1); // Pause
+    std::cout << "Audio playback stopped" << std::endl;
+}
+
+void SdlAudioPlayback::AudioCallback(void* userdata, uint8_t* stream, int len) {
+    SdlAudioPlayback* self = static_cast<SdlAudioPlayback*>(userdata);
+    // SDL owns this thread, so the policy can only be applied from inside it
+    self->ApplyPendingThreadPolicy("uvc2gl-sdlaudio");
+    int16_t* output = reinterpret_cast<int16_t*>(stream);
+    int frameCount = len / (sizeof(int16_t) * self->m_AudioSpec.channels);
+    
+    self->Render(output, frameCount);
+}
+
+} // namespace uvc2gl
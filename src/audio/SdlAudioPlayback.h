@@ -0,0 +1,27 @@
+#pragma once
+
+#include "AudioPlayback.h"
+#include <SDL2/SDL.h>
+
+namespace uvc2gl {
+
+// Plays through SDL's default output device (PulseAudio unless overridden);
+// SDL's own audio thread pulls samples from its callback
+class SdlAudioPlayback : public AudioPlayback {
+public:
+    SdlAudioPlayback(unsigned int sampleRate = 48000, unsigned int channels = 2, size_t bufferFrames = 1024);
+    ~SdlAudioPlayback() override;
+
+    const char* Name() const override { return "sdl"; }
+
+    void Start() override;
+    void Stop() override;
+
+private:
+    static void AudioCallback(void* userdata, uint8_t* stream, int len);
+
+    SDL_AudioDeviceID m_DeviceID;
+    SDL_AudioSpec m_AudioSpec;
+};
+
+} // namespace uvc2gl
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace uvc2gl {
+
+// Blackman-windowed sinc shared by VariableResampler and FixedResampler.
+// A filter of half taps either side of the centre has 2 * half taps; tap j
+// weighs input frame (centre - half + 1 + j).
+
+// Cutoff as a fraction of the input's Nyquist frequency: just under it, so
+// images stay out without a long transition band
+inline constexpr double kSincCutoff = 0.92;
+
+// Fills the 2 * half taps for an output frac (0 to 1) of a frame past the centre
+inline void BlackmanSincTaps(double cutoff, int half, double frac, float* taps) {
+    double sum = 0.0;
+    for (int j = 0; j < 2 * half; ++j) {
+        const double x = (j - half + 1) - frac;
+        const double arg = M_PI * cutoff * x;
+        const double sinc = (x == 0.0) ? 1.0 : std::sin(arg) / arg;
+        const double w = x / half;
+        const double window = (std::abs(w) >= 1.0) ? 0.0
+                              : 0.42 + 0.5 * std::cos(M_PI * w) + 0.08 * std::cos(2.0 * M_PI * w);
+        taps[j] = static_cast<float>(sinc * window);
+        sum += sinc * window;
+    }
+    // Unity gain at DC for every phase
+    for (int j = 0; j < 2 * half; ++j) {
+        taps[j] = static_cast<float>(taps[j] / sum);
+    }
+}
+
+// Silent frames a resampler starts (and resets) with, so the first real
+// frame is centred with full support
+inline size_t SincHistoryFrames(int half) {
+    return static_cast<size_t>(half - 1);
+}
+
+// Input frames the filter no longer reaches once the next output is
+// centred on frame centre, out of the frames buffered
+inline size_t SincSpentFrames(size_t centre, int half, size_t frames) {
+    const size_t history = SincHistoryFrames(half);
+    return centre > history ? std::min(centre - history, frames) : 0;
+}
+
+} // namespace uvc2gl
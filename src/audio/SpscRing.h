@@ -0,0 +1,91 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace uvc2gl {
+
+// Wait-free ring for exactly one producer thread and one consumer thread.
+// Capacity is rounded up to a power of two so positions wrap with a mask;
+// the positions themselves only ever grow, so full and empty never look
+// alike. Reads and writes are at most two memcpys (before and after the
+// wrap).
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing copies elements with memcpy");
+
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_capacity = size;
+        m_mask = size - 1;
+        m_data = std::make_unique<T[]>(size);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: copies as many of count elements as fit, returns how many
+    size_t Write(const T* src, size_t count) {
+        const size_t write = m_write.load(std::memory_order_relaxed);
+        const size_t read = m_read.load(std::memory_order_acquire);
+        count = std::min(count, m_capacity - (write - read));
+        CopyIn(write & m_mask, src, count);
+        m_write.store(write + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: copies up to count elements out, returns how many
+    size_t Read(T* dst, size_t count) {
+        const size_t read = m_read.load(std::memory_order_relaxed);
+        const size_t write = m_write.load(std::memory_order_acquire);
+        count = std::min(count, write - read);
+        CopyOut(read & m_mask, dst, count);
+        m_read.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: discards up to count elements, returns how many
+    size_t Skip(size_t count) {
+        const size_t read = m_read.load(std::memory_order_relaxed);
+        const size_t write = m_write.load(std::memory_order_acquire);
+        count = std::min(count, write - read);
+        m_read.store(read + count, std::memory_order_release);
+        return count;
+    }
+
+    // Snapshot from either side; exact only on the calling side's own end
+    size_t Size() const {
+        return m_write.load(std::memory_order_acquire) - m_read.load(std::memory_order_acquire);
+    }
+    size_t Capacity() const { return m_capacity; }
+
+private:
+    void CopyIn(size_t offset, const T* src, size_t count) {
+        const size_t first = std::min(count, m_capacity - offset);
+        std::memcpy(m_data.get() + offset, src, first * sizeof(T));
+        std::memcpy(m_data.get(), src + first, (count - first) * sizeof(T));
+    }
+
+    void CopyOut(size_t offset, T* dst, size_t count) const {
+        const size_t first = std::min(count, m_capacity - offset);
+        std::memcpy(dst, m_data.get() + offset, first * sizeof(T));
+        std::memcpy(dst + first, m_data.get(), (count - first) * sizeof(T));
+    }
+
+    std::unique_ptr<T[]> m_data;
+    size_t m_capacity;
+    size_t m_mask;
+    // Separate cache lines so producer and consumer don't false-share
+    alignas(64) std::atomic<size_t> m_write{0};
+    alignas(64) std::atomic<size_t> m_read{0};
+};
+
+} // namespace uvc2gl
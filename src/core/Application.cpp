@@ -4,19 +4,23 @@
 #include <imgui_impl_sdl2.h>
 #include <imgui_impl_opengl3.h>
 #include <linux/videodev2.h>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <optional>
 #include <thread>
 
 namespace uvc2gl {
 
 // Helper function to convert format string to V4L2 pixel format
 static uint32_t GetPixelFormat(const std::string& format) {
-    if (format == "YUYV") {
-        return V4L2_PIX_FMT_YUYV;
-    } else {
-        return V4L2_PIX_FMT_MJPEG;
-    }
+    return V4L2Capabilities::PixelFormatFromName(format);
+}
+
+// Formats we can capture: MJPEG, H.264 plus anything the converter registry handles
+static bool IsCapturableFormat(uint32_t pixelFormat) {
+    return VideoCapture::SupportsFormat(pixelFormat);
 }
 
 Application::Application(const char* title, int width, int height) {
@@ -31,6 +35,17 @@ Application::Application(const char* title, int width, int height) {
     
     // Load config
     m_config.LoadFromFile(m_configPath);
+    m_avSync.SetEnabled(m_config.avSync);
+    m_avSync.SetUserOffset(std::clamp(m_config.avSyncOffsetMs, -static_cast<int>(AvSync::kMaxDelayMs),
+                                      static_cast<int>(AvSync::kMaxDelayMs)));
+    m_renderer->SetLayout(m_config.layout == "pip" ? CompositeLayout::PictureInPicture : CompositeLayout::Grid);
+    
+    // One thread waits on every capture device; decoding runs as jobs on
+    // one worker per core, shared by every source
+    m_ioReactor = std::make_shared<IoReactor>(ThreadPolicy::Parse(m_config.ioThreadPolicy, m_config.ioThreadCores));
+    m_jobSystem = std::make_shared<JobSystem>(std::max(0, m_config.jobWorkers),
+                                              ThreadPolicy::Parse(m_config.jobThreadPolicy, m_config.jobThreadCores));
+    m_decoderPool = std::make_shared<DecoderPool>(m_jobSystem);
     
     // Enumerate available devices
     m_availableDevices = V4L2Capabilities::EnumerateDevices();
@@ -63,6 +78,19 @@ Application::Application(const char* title, int width, int height) {
     m_currentHeight = m_config.height;
     m_currentFps = m_config.fps;
     m_currentFormat = m_config.videoFormat;
+    if (!IsCapturableFormat(GetPixelFormat(m_currentFormat))) {
+        std::cout << "Unsupported video format " << m_currentFormat << ", using MJPEG" << std::endl;
+        m_currentFormat = "MJPEG";
+    }
+    
+    // Fall back to FFmpeg if the saved MJPEG backend isn't compiled in
+    m_currentMjpegBackend = "ffmpeg";
+    for (const auto& backend : MjpgBackend::Available()) {
+        if (backend == m_config.mjpegBackend) {
+            m_currentMjpegBackend = backend;
+            break;
+        }
+    }
     
     bool formatFound = false;
     if (!m_availableFormats.empty()) {
@@ -87,8 +115,11 @@ Application::Application(const char* title, int width, int height) {
     
     // Try to initialize video capture (may fail if device not available)
     try {
-        m_video = std::make_unique<VideoCapture>(m_currentDevice, m_currentWidth, m_currentHeight, m_currentFps, m_currentFormat, 10);
+        m_video = CreateCapture(m_currentDevice, m_currentWidth, m_currentHeight, m_currentFps, m_currentFormat);
         m_decoder = std::make_unique<MjpgDecoder>();
+        m_videoDisplay = m_video->Bus().Subscribe("display", FrameDropPolicy::LatestOnly);
+        m_videoTiming.held.clear();
+        m_avSync.Reset();
         m_video->Start();
         
         // Give it a moment to start up and validate it's actually working
@@ -108,6 +139,20 @@ Application::Application(const char* title, int width, int height) {
         m_decoder.reset();
     }
     
+    // Sources composited alongside the main one
+    size_t start = 0;
+    while (start < m_config.extraVideoDevices.size()) {
+        size_t end = m_config.extraVideoDevices.find(',', start);
+        if (end == std::string::npos) {
+            end = m_config.extraVideoDevices.size();
+        }
+        std::string device = m_config.extraVideoDevices.substr(start, end - start);
+        if (!device.empty()) {
+            AddSource(device);
+        }
+        start = end + 1;
+    }
+    
     // Initialize audio capture
     m_availableAudioDevices = ALSACapabilities::EnumerateDevices();
     
@@ -135,33 +180,40 @@ Application::Application(const char* title, int width, int height) {
         }
     }
     
+    // Initialize audio playback first: capture feeds it directly
     try {
-        m_audio = std::make_unique<AudioCapture>(m_currentAudioDevice, 48000, 2, 1024);
+        m_audioPlayback = CreateAudioPlayback();
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: Failed to initialize audio playback: " << e.what() << std::endl;
+        std::cerr << "Running without audio output." << std::endl;
+    }
+
+    try {
+        m_audio = CreateAudioCapture(m_currentAudioDevice);
         m_audio->Start();
         std::cout << "Audio capture started on " << m_currentAudioDevice << std::endl;
     } catch (const std::exception& e) {
         std::cerr << "Warning: Failed to initialize audio capture: " << e.what() << std::endl;
         std::cerr << "Running without audio input." << std::endl;
     }
-    
-    // Initialize audio playback
-    try {
-        m_audioPlayback = std::make_unique<AudioPlayback>(48000, 2);
-        m_audioPlayback->Start();
-        // Restore saved volume
-        m_audioPlayback->SetVolume(m_config.volume);
-    } catch (const std::exception& e) {
-        std::cerr << "Warning: Failed to initialize audio playback: " << e.what() << std::endl;
-        std::cerr << "Running without audio output." << std::endl;
+
+    if (!m_config.statsLog.empty()) {
+        try {
+            m_telemetry = std::make_unique<TelemetryLog>(m_config.statsLog);
+            std::cout << "Logging stats to " << m_config.statsLog << " every "
+                      << std::max(100, m_config.statsLogIntervalMs) << " ms" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
     }
 }
 
 Application::~Application() {
     std::cout << "Shutting down application..." << std::endl;
     
-    // Save config before shutting down
+    // Save config before shutting down; queued writes die with the job system
     try {
-        SaveConfig();
+        SaveConfig(true);
     } catch (const std::exception& e) {
         std::cerr << "Error saving config: " << e.what() << std::endl;
     }
@@ -187,6 +239,9 @@ Application::~Application() {
         if (m_video) {
             m_video->Stop();
         }
+        for (auto& source : m_extraSources) {
+            source.capture->Stop();
+        }
     } catch (const std::exception& e) {
         std::cerr << "Error stopping video capture: " << e.what() << std::endl;
     }
@@ -203,6 +258,11 @@ Application::~Application() {
 void Application::Run() {
     std::cout << "Entering main loop..." << std::endl;
     while (!m_window->ShouldClose()) {
+        if (!m_isVisible) {
+            // No vsync to pace the loop while hidden; sleep until an event
+            // arrives or it's time to move the next audio period
+            SDL_WaitEventTimeout(nullptr, 5);
+        }
         ProcessInput();
         Update();
         Render();
@@ -245,33 +305,324 @@ void Application::ProcessInput() {
                 int newWidth = event.window.data1;
                 int newHeight = event.window.data2;
                 m_window->UpdateSize(newWidth, newHeight);
+            } else if (event.window.event == SDL_WINDOWEVENT_HIDDEN ||
+                       event.window.event == SDL_WINDOWEVENT_MINIMIZED) {
+                SetWindowVisible(false);
+            } else if (event.window.event == SDL_WINDOWEVENT_SHOWN ||
+                       event.window.event == SDL_WINDOWEVENT_RESTORED ||
+                       event.window.event == SDL_WINDOWEVENT_MAXIMIZED ||
+                       event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                SetWindowVisible(true);
             }
         }
     }
 }
 
 void Application::Update() {
-    // Get the latest frame from video capture
-    if (m_video) {
-        auto frameOpt = m_video->GetFrame();
-        if (frameOpt.has_value()) {
-            auto& frame = frameOpt.value();
-            
-            // Frame is already decoded to RGB in the capture thread
-            // Just upload directly to GPU
-            if (!frame.data.empty() && frame.width > 0 && frame.height > 0) {
-                m_renderer->UploadVideoFrame(frame.width, frame.height, frame.data);
+    TuneAudioPeriods();
+
+    // Audio's capture-to-output latency without the sync delay: capture
+    // side, plus the queue depth the drift controller holds, plus the device
+    TelemetrySample sample;
+    if (m_audio && m_audioPlayback) {
+        sample.hasAudio = true;
+        sample.capture = m_audio->GetStats();
+        sample.playback = m_audioPlayback->GetStats();
+        const AudioCaptureStats& capture = sample.capture;
+        const PlaybackStats& playback = sample.playback;
+        if (capture.periodsCaptured > 0 && playback.targetMs > 0.0) {
+            m_avSync.OnAudioLatency(capture.avgLatencyMs + playback.targetMs - playback.syncDelayMs +
+                                    playback.outputDelayMs);
+        }
+    }
+    m_avSync.Update();
+    if (m_audioPlayback) {
+        m_audioPlayback->SetSyncDelay(m_avSync.AudioDelayMs());
+    }
+
+    const int64_t now = MonotonicNowNs();
+    if (m_telemetry && now - m_lastTelemetryNs >= std::max(100, m_config.statsLogIntervalMs) * 1000000LL) {
+        m_lastTelemetryNs = now;
+        sample.timeNs = now;
+        if (m_video) {
+            sample.hasVideo = true;
+            sample.video = m_video->GetStats();
+            sample.videoFps = m_videoTiming.Fps();
+            sample.videoUploadAgeMs = m_videoTiming.avgUploadAgeMs;
+        }
+        sample.sync = m_avSync.GetStats();
+        m_telemetry->Write(sample);
+    }
+
+    // Get the latest frame from every video source
+    if (m_isVisible) {
+        if (m_video && m_videoDisplay) {
+            PresentFrame(0, *m_videoDisplay, m_videoTiming);
+        }
+        for (size_t i = 0; i < m_extraSources.size(); ++i) {
+            PresentFrame(static_cast<int>(i) + 1, *m_extraSources[i].display, m_extraSources[i].timing);
+        }
+    }
+}
+
+void Application::PresentFrame(int source, FrameSubscription& display, FrameTiming& timing) {
+    // Frame timestamps are CLOCK_MONOTONIC, like steady_clock
+    const int64_t now = MonotonicNowNs();
+    const uint64_t nowNs = static_cast<uint64_t>(now);
+
+    auto arrived = display.Pop();
+    if (arrived.has_value() && !arrived->Empty()) {
+        if (source == 0) {
+            m_avSync.OnVideoFrame(static_cast<int64_t>(arrived->timestamp), now);
+        }
+        // A frame waiting out the sync delay would keep its V4L2 buffer from
+        // the driver; with only a few buffers, capture then drops frames as
+        // if the decoder were behind. Copy those before holding them.
+        if (arrived->deviceBuffer && m_avSync.VideoDelayNs() > 0) {
+            timing.held.push_back(m_heldFramePool.Copy(*arrived));
+        } else {
+            timing.held.push_back(std::move(*arrived));
+        }
+        // Frames only pile up if the delay outgrows the frame interval;
+        // the cap bounds the buffers they keep alive
+        while (timing.held.size() > 32) {
+            timing.held.pop_front();
+        }
+    }
+
+    // Newest frame whose sync delay has passed; older due ones are skipped.
+    // Every source gets the same delay so composited sources stay together.
+    const uint64_t delayNs = static_cast<uint64_t>(m_avSync.VideoDelayNs());
+    std::optional<Frame> due;
+    while (!timing.held.empty() &&
+           (timing.held.front().timestamp == 0 || timing.held.front().timestamp + delayNs <= nowNs)) {
+        due = std::move(timing.held.front());
+        timing.held.pop_front();
+    }
+    if (!due.has_value()) {
+        return;
+    }
+    auto& frame = due.value();
+    
+    // Frame is already decoded (RGB or a YCbCr layout the renderer
+    // accepts) off the main thread. Just upload directly to GPU
+    m_renderer->UploadVideoFrame(source, frame);
+    
+    if (frame.timestamp > 0 && nowNs >= frame.timestamp) {
+        double ageMs = (nowNs - frame.timestamp) / 1e6;
+        timing.avgUploadAgeMs = timing.avgUploadAgeMs == 0.0 ? ageMs : timing.avgUploadAgeMs * 0.95 + ageMs * 0.05;
+    }
+    if (timing.lastTimestamp > 0 && frame.timestamp > timing.lastTimestamp) {
+        double intervalMs = (frame.timestamp - timing.lastTimestamp) / 1e6;
+        timing.avgIntervalMs = timing.avgIntervalMs == 0.0 ? intervalMs : timing.avgIntervalMs * 0.95 + intervalMs * 0.05;
+    }
+    timing.lastTimestamp = frame.timestamp;
+}
+
+std::unique_ptr<VideoCapture> Application::CreateCapture(const std::string& device, int width, int height, int fps,
+                                                         const std::string& format) {
+    auto capture = std::make_unique<VideoCapture>(device, width, height, fps, format, m_currentMjpegBackend);
+    capture->SetOutputFormats(Renderer::SupportedFormats());
+    capture->SetReactor(m_ioReactor);
+    capture->SetDecoderPool(m_decoderPool);
+    return capture;
+}
+
+std::unique_ptr<AudioCapture> Application::CreateAudioCapture(const std::string& device) {
+    // Start from what this device settled on last time, or small
+    int period = AppConfig::LookupPeriod(m_config.audioCapturePeriods, device, PeriodTuner::kDefaultFrames);
+    m_captureTuner = std::make_unique<PeriodTuner>(static_cast<size_t>(std::max(1, period)));
+    auto capture = std::make_unique<AudioCapture>(device, 48000, 2, m_captureTuner->Frames());
+    capture->SetReactor(m_ioReactor);
+    if (m_audioPlayback) {
+        // Periods go from the reactor thread straight into the playback
+        // ring, whatever the render loop is doing, converted on the way if
+        // the card doesn't capture what the output plays
+        AudioPlayback* playback = m_audioPlayback.get();
+        auto converter = std::make_shared<AudioConverter>(playback->SampleRate(), playback->Channels());
+        capture->SetSink([playback, converter](const AudioPeriod& period) {
+            if (period.frameCount == 0) {
+                return true;
+            }
+            size_t frames = 0;
+            const int16_t* samples = converter->Convert(period.data, period.format, period.frameCount, frames);
+            if (!samples) {
+                return false; // A rate it can't resample: counted as dropped
             }
+            // No output yet is fine while the resampler fills its history
+            return frames == 0 || playback->QueueAudio(samples, frames);
+        });
+    }
+    return capture;
+}
+
+std::unique_ptr<AudioPlayback> Application::CreateAudioPlayback() {
+    std::unique_ptr<AudioPlayback> playback;
+    m_outputTuner.reset();
+    try {
+        if (m_config.audioOutput == "alsa") {
+            int period = AppConfig::LookupPeriod(m_config.audioOutputPeriods, m_config.audioOutputDevice,
+                                                 PeriodTuner::kDefaultFrames);
+            m_outputTuner = std::make_unique<PeriodTuner>(static_cast<size_t>(std::max(1, period)));
+            playback = AudioPlayback::Create("alsa", m_config.audioOutputDevice, 48000, 2, m_outputTuner->Frames());
+        } else {
+            // SDL reports no device underruns to adapt to, so it keeps its default
+            playback = AudioPlayback::Create(m_config.audioOutput, m_config.audioOutputDevice, 48000, 2);
+        }
+    } catch (const std::exception& e) {
+        if (m_config.audioOutput == "sdl") {
+            throw;
+        }
+        std::cerr << "Warning: " << e.what() << ", falling back to SDL output" << std::endl;
+        m_outputTuner.reset();
+        playback = AudioPlayback::Create("sdl");
+    }
+    playback->SetThreadPolicy(ThreadPolicy::Parse(m_config.audioThreadPolicy, m_config.audioThreadCores));
+    playback->SetTargetLatency(std::max(1, m_config.audioTargetLatencyMs));
+    playback->Start();
+    // Restore saved volume
+    playback->SetVolume(m_config.volume);
+    return playback;
+}
+
+void Application::TuneAudioPeriods() {
+    const auto now = PeriodTuner::Clock::now();
+    bool restartCapture = false;
+
+    if (m_audio && m_captureTuner && m_captureTuner->Update(m_audio->GetStats().xruns, now)) {
+        std::cout << "Audio capture overruns on " << m_currentAudioDevice << ", raising the period to "
+                  << m_captureTuner->Frames() << " frames" << std::endl;
+        AppConfig::StorePeriod(m_config.audioCapturePeriods, m_currentAudioDevice,
+                               static_cast<int>(m_captureTuner->Frames()));
+        restartCapture = true;
+    }
+
+    bool restartOutput = false;
+    // An output whose device failed for good has stopped; reopen it, but
+    // not more often than kOutputReopenInterval if it keeps failing
+    if (m_audioPlayback && !m_audioPlayback->IsRunning() && now - m_outputReopenTime >= kOutputReopenInterval) {
+        std::cout << "Audio output stopped, reopening" << std::endl;
+        m_outputReopenTime = now;
+        restartOutput = true;
+    }
+    if (!restartOutput && m_audioPlayback && m_outputTuner &&
+        m_outputTuner->Update(m_audioPlayback->GetStats().deviceXruns, now)) {
+        std::cout << "Audio output underruns on " << m_config.audioOutputDevice << ", raising the period to "
+                  << m_outputTuner->Frames() << " frames" << std::endl;
+        AppConfig::StorePeriod(m_config.audioOutputPeriods, m_config.audioOutputDevice,
+                               static_cast<int>(m_outputTuner->Frames()));
+        restartOutput = true;
+    }
+
+    if (!restartCapture && !restartOutput) {
+        return;
+    }
+
+    // Capture feeds playback directly, so it stops first either way
+    if (m_audio) {
+        m_audio->Stop();
+        m_audio.reset();
+    }
+    if (restartOutput) {
+        m_config.volume = m_audioPlayback->GetVolume();
+        m_audioPlayback.reset();
+        try {
+            m_audioPlayback = CreateAudioPlayback();
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to reopen audio output: " << e.what() << std::endl;
+        }
+    }
+    try {
+        m_audio = CreateAudioCapture(m_currentAudioDevice);
+        m_audio->Start();
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to reopen audio capture: " << e.what() << std::endl;
+        m_audio.reset();
+    }
+    m_avSync.Reset();
+    SaveConfig();
+}
+
+bool Application::AddSource(const std::string& devicePath) {
+    if (devicePath == m_currentDevice || 1 + m_extraSources.size() >= static_cast<size_t>(kMaxVideoSources)) {
+        return false;
+    }
+    for (const auto& source : m_extraSources) {
+        if (source.device == devicePath) {
+            return false;
         }
     }
     
-    // Get and play audio
-    if (m_audio && m_audioPlayback) {
-        AudioFrame audioFrame;
-        if (m_audio->GetAudioFrame(audioFrame)) {
-            if (!audioFrame.samples.empty()) {
-                m_audioPlayback->QueueAudio(audioFrame.samples.data(), audioFrame.frameCount);
+    // Prefer the main source's format and mode, then anything capturable
+    std::vector<VideoFormat> formats = V4L2Capabilities::QueryFormats(devicePath);
+    const VideoFormat* chosen = nullptr;
+    for (const auto& format : formats) {
+        if (format.pixelFormat == GetPixelFormat(m_currentFormat) && format.width == m_currentWidth &&
+            format.height == m_currentHeight && format.fps == m_currentFps) {
+            chosen = &format;
+            break;
+        }
+    }
+    for (const auto& format : formats) {
+        if (!chosen && format.pixelFormat == GetPixelFormat(m_currentFormat)) {
+            chosen = &format;
+        }
+    }
+    for (const auto& format : formats) {
+        if (!chosen && IsCapturableFormat(format.pixelFormat)) {
+            chosen = &format;
+        }
+    }
+    if (!chosen) {
+        std::cerr << "No capturable formats available for device " << devicePath << std::endl;
+        return false;
+    }
+    
+    ExtraSource source;
+    source.device = devicePath;
+    source.width = chosen->width;
+    source.height = chosen->height;
+    source.fps = chosen->fps;
+    source.format = V4L2Capabilities::FormatName(chosen->pixelFormat);
+    try {
+        source.capture = CreateCapture(source.device, source.width, source.height, source.fps, source.format);
+        source.display = source.capture->Bus().Subscribe("display", FrameDropPolicy::LatestOnly);
+        source.capture->SetDecodeEnabled(m_isVisible);
+        source.capture->Start();
+        
+        // Give it a moment to validate it's working
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (!source.capture->IsRunning()) {
+            std::cerr << "Video capture failed to start on " << devicePath << std::endl;
+            return false;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to add video source " << devicePath << ": " << e.what() << std::endl;
+        return false;
+    }
+    std::cout << "Added video source " << devicePath << " at " << source.width << "x" << source.height
+              << "@" << source.fps << " " << source.format << std::endl;
+    m_extraSources.push_back(std::move(source));
+    return true;
+}
+
+void Application::RemoveSource(const std::string& devicePath) {
+    for (auto it = m_extraSources.begin(); it != m_extraSources.end(); ++it) {
+        if (it->device == devicePath) {
+            try {
+                it->capture->Stop();
+            } catch (const std::exception& e) {
+                std::cerr << "Error stopping video: " << e.what() << std::endl;
             }
+            // Later sources shift down a slot; clear from the removed one to
+            // the end so none of them shows a picture or aspect left behind
+            const int slot = static_cast<int>(it - m_extraSources.begin()) + 1;
+            for (int i = slot; i <= static_cast<int>(m_extraSources.size()); ++i) {
+                m_renderer->ClearSource(i);
+            }
+            m_extraSources.erase(it);
+            std::cout << "Removed video source " << devicePath << std::endl;
+            return;
         }
     }
 }
@@ -373,35 +724,177 @@ void Application::RenderUI() {
                 
                 ImGui::Text("Video Format");
                 ImGui::Indent();
-                const char* formats[] = { "MJPEG", "YUYV" };
-                int currentFormatIdx = (m_currentFormat == "YUYV") ? 1 : 0;
+                // Offer every FourCC the device reports that we can capture
+                std::vector<std::string> formatNames;
+                for (const auto& format : m_availableFormats) {
+                    if (!IsCapturableFormat(format.pixelFormat)) {
+                        continue;
+                    }
+                    std::string name = V4L2Capabilities::FormatName(format.pixelFormat);
+                    if (std::find(formatNames.begin(), formatNames.end(), name) == formatNames.end()) {
+                        formatNames.push_back(name);
+                    }
+                }
+                std::string newFormat = m_currentFormat;
                 ImGui::SetNextItemWidth(200);
-                if (ImGui::Combo("##format", &currentFormatIdx, formats, 2)) {
-                    std::string newFormat = formats[currentFormatIdx];
-                    if (newFormat != m_currentFormat) {
-                        m_currentFormat = newFormat;
-                        
-                        // Find first available resolution for the new format
-                        uint32_t newPixelFormat = GetPixelFormat(m_currentFormat);
-                        bool foundFormat = false;
-                        for (const auto& format : m_availableFormats) {
-                            if (format.pixelFormat == newPixelFormat) {
-                                m_currentWidth = format.width;
-                                m_currentHeight = format.height;
-                                m_currentFps = format.fps;
-                                foundFormat = true;
-                                break;
-                            }
+                if (ImGui::BeginCombo("##format", m_currentFormat.c_str())) {
+                    for (const auto& name : formatNames) {
+                        bool isSelected = (name == m_currentFormat);
+                        if (ImGui::Selectable(name.c_str(), isSelected)) {
+                            newFormat = name;
                         }
-                        
-                        if (foundFormat) {
-                            RestartCapture(m_currentWidth, m_currentHeight, m_currentFps);
-                            SaveConfig();
+                        if (isSelected) {
+                            ImGui::SetItemDefaultFocus();
                         }
                     }
+                    ImGui::EndCombo();
+                }
+                if (newFormat != m_currentFormat) {
+                    m_currentFormat = newFormat;
+                    
+                    // Find first available resolution for the new format
+                    uint32_t newPixelFormat = GetPixelFormat(m_currentFormat);
+                    bool foundFormat = false;
+                    for (const auto& format : m_availableFormats) {
+                        if (format.pixelFormat == newPixelFormat) {
+                            m_currentWidth = format.width;
+                            m_currentHeight = format.height;
+                            m_currentFps = format.fps;
+                            foundFormat = true;
+                            break;
+                        }
+                    }
+                    
+                    if (foundFormat) {
+                        RestartCapture(m_currentWidth, m_currentHeight, m_currentFps);
+                        SaveConfig();
+                    }
                 }
                 ImGui::Unindent();
                 ImGui::Spacing();
+
+                std::vector<std::string> backends = MjpgBackend::Available();
+                if (backends.size() > 1) {
+                    ImGui::Text("MJPEG Decoder");
+                    ImGui::Indent();
+                    ImGui::SetNextItemWidth(200);
+                    if (ImGui::BeginCombo("##mjpegbackend", m_currentMjpegBackend.c_str())) {
+                        for (const auto& backend : backends) {
+                            bool isSelected = (backend == m_currentMjpegBackend);
+                            if (ImGui::Selectable(backend.c_str(), isSelected) && !isSelected) {
+                                m_currentMjpegBackend = backend;
+                                RestartCapture(m_currentWidth, m_currentHeight, m_currentFps);
+                            }
+                            if (isSelected) {
+                                ImGui::SetItemDefaultFocus();
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+                    ImGui::Unindent();
+                    ImGui::Spacing();
+                }
+
+                if (m_availableDevices.size() > 1) {
+                    ImGui::Text("Additional Sources");
+                    ImGui::Indent();
+                    for (const auto& device : m_availableDevices) {
+                        if (device.path == m_currentDevice) {
+                            continue;
+                        }
+                        bool isActive = std::any_of(m_extraSources.begin(), m_extraSources.end(),
+                                                    [&](const ExtraSource& source) { return source.device == device.path; });
+                        ImGui::PushID(device.path.c_str());
+                        if (ImGui::MenuItem(device.displayName().c_str(), nullptr, isActive)) {
+                            if (isActive) {
+                                RemoveSource(device.path);
+                            } else {
+                                AddSource(device.path);
+                            }
+                            SaveConfig();
+                        }
+                        ImGui::PopID();
+                    }
+                    if (!m_extraSources.empty()) {
+                        const char* layouts[] = { "Grid", "Picture-in-picture" };
+                        int layout = m_renderer->GetLayout() == CompositeLayout::PictureInPicture ? 1 : 0;
+                        ImGui::SetNextItemWidth(200);
+                        if (ImGui::Combo("##layout", &layout, layouts, 2)) {
+                            m_renderer->SetLayout(layout == 1 ? CompositeLayout::PictureInPicture : CompositeLayout::Grid);
+                            SaveConfig();
+                        }
+                    }
+                    ImGui::Unindent();
+                    ImGui::Spacing();
+                }
+
+                if (m_video) {
+                    ImGui::Text("Statistics");
+                    ImGui::Indent();
+                    CaptureStats stats = m_video->GetStats();
+                    ImGui::Text("Captured: %llu", static_cast<unsigned long long>(stats.framesCaptured));
+                    ImGui::Text("Decoded: %llu (%.2f ms avg)", static_cast<unsigned long long>(stats.framesDecoded), stats.avgDecodeMs);
+                    ImGui::Text("Capture latency: %.2f ms avg", stats.avgCaptureLatencyMs);
+                    if (stats.decodeScale > 1) {
+                        ImGui::Text("Decode scale: 1/%d", stats.decodeScale);
+                    }
+                    ImGui::Text("Duplicates skipped: %llu (~%.0f ms saved)",
+                                static_cast<unsigned long long>(stats.framesDuplicate), stats.DecodeMsSaved());
+                    if (stats.framesSuspended > 0) {
+                        ImGui::Text("Skipped while hidden: %llu", static_cast<unsigned long long>(stats.framesSuspended));
+                    }
+                    if (stats.framesFailed > 0) {
+                        ImGui::Text("Decode failures: %llu", static_cast<unsigned long long>(stats.framesFailed));
+                    }
+                    if (stats.framesOverrun > 0) {
+                        ImGui::Text("Dropped (decoder behind): %llu", static_cast<unsigned long long>(stats.framesOverrun));
+                    }
+                    for (const auto& subscriber : stats.subscribers) {
+                        ImGui::Text("%s: %.2f ms lag, %llu behind, %llu dropped", subscriber.name.c_str(), subscriber.avgLagMs,
+                                    static_cast<unsigned long long>(subscriber.framesBehind),
+                                    static_cast<unsigned long long>(subscriber.dropped));
+                    }
+                    ImGui::Text("%s: %.1f fps, %.2f ms capture to upload", m_currentDevice.c_str(),
+                                m_videoTiming.Fps(), m_videoTiming.avgUploadAgeMs);
+                    if (m_audio && m_audioPlayback) {
+                        // Audio's health next to video's, so a glitch on either can be matched up
+                        TelemetrySample audio;
+                        audio.capture = m_audio->GetStats();
+                        audio.playback = m_audioPlayback->GetStats();
+                        const PlaybackStats& playback = audio.playback;
+                        ImGui::Text("Audio: %.1f ms capture to output (%.1f capture, %.1f queued, %.1f device)",
+                                    audio.AudioLatencyMs(), audio.capture.avgLatencyMs, audio.AudioQueueMs(),
+                                    playback.outputDelayMs);
+                        ImGui::Text("Audio buffer: %.0f%% full, %llu underruns, %llu overruns, %llu xruns recovered",
+                                    playback.FillPercent(), static_cast<unsigned long long>(playback.underruns),
+                                    static_cast<unsigned long long>(playback.overruns),
+                                    static_cast<unsigned long long>(audio.capture.xruns + playback.deviceXruns));
+                    }
+                    if (m_telemetry) {
+                        ImGui::Text("Logging to %s", m_telemetry->Path().c_str());
+                    }
+                    for (const auto& source : m_extraSources) {
+                        CaptureStats sourceStats = source.capture->GetStats();
+                        ImGui::Text("%s: %.1f fps, %.2f ms capture to upload, %.2f ms decode", source.device.c_str(),
+                                    source.timing.Fps(), source.timing.avgUploadAgeMs, sourceStats.avgDecodeMs);
+                    }
+                    std::vector<JobWorkerStats> workers = m_jobSystem->GetStats();
+                    for (size_t i = 0; i < workers.size(); ++i) {
+                        const JobWorkerStats& worker = workers[i];
+                        ImGui::Text("Worker %zu%s: %.0f%% busy, %llu jobs (%llu stolen), %zu queued", i,
+                                    worker.core >= 0 ? (" (core " + std::to_string(worker.core) + ")").c_str() : "",
+                                    worker.busyPercent, static_cast<unsigned long long>(worker.executed),
+                                    static_cast<unsigned long long>(worker.stolen), worker.queued);
+                    }
+                    for (const auto& thread : ThreadPolicyReport()) {
+                        ImGui::Text("%s: %s", thread.name.c_str(), thread.applied.ToString().c_str());
+                        if (!thread.note.empty() && ImGui::IsItemHovered()) {
+                            ImGui::SetTooltip("Requested %s; %s", thread.requested.ToString().c_str(), thread.note.c_str());
+                        }
+                    }
+                    ImGui::Unindent();
+                    ImGui::Spacing();
+                }
             }
             
             // Audio section
@@ -436,6 +929,82 @@ void Application::RenderUI() {
                         }
                     }
                     ImGui::Unindent();
+                    ImGui::Spacing();
+
+                    if (m_audio) {
+                        AudioCaptureStats capture = m_audio->GetStats();
+                        ImGui::Text("Capture");
+                        ImGui::Indent();
+                        ImGui::Text("Periods: %llu (%llu dropped, queue full)",
+                                    static_cast<unsigned long long>(capture.periodsCaptured),
+                                    static_cast<unsigned long long>(capture.periodsDropped));
+                        const AudioFormat format = m_audio->Format();
+                        const bool converted = format.format != SampleFormat::S16 ||
+                                               format.sampleRate != m_audioPlayback->SampleRate() ||
+                                               format.channels != m_audioPlayback->Channels();
+                        ImGui::Text("Format: %s, %u ch, %u Hz%s", SampleFormatName(format.format), format.channels,
+                                    format.sampleRate, converted ? " (converted for output)" : "");
+                        ImGui::Text("Period: %lu frames (%.1f ms)", static_cast<unsigned long>(m_audio->PeriodSize()),
+                                    m_audio->PeriodSize() * 1000.0 / m_audio->SampleRate());
+                        ImGui::Text("Overruns recovered: %llu", static_cast<unsigned long long>(capture.xruns));
+                        if (capture.shortReads > 0) {
+                            ImGui::Text("Short reads: %llu", static_cast<unsigned long long>(capture.shortReads));
+                        }
+                        ImGui::Text("Latency: %.1f ms (%s, %s timestamps)", capture.avgLatencyMs,
+                                    capture.mmap ? "mmap" : "read", capture.hardwareTimestamps ? "hardware" : "arrival");
+                        ImGui::Unindent();
+                    }
+
+                    PlaybackStats playback = m_audioPlayback->GetStats();
+                    ImGui::Text("Playback buffer");
+                    ImGui::Indent();
+                    ImGui::ProgressBar(static_cast<float>(playback.FillPercent() / 100.0), ImVec2(200, 0));
+                    ImGui::Text("%zu of %zu frames queued", playback.queuedFrames, playback.capacityFrames);
+                    ImGui::Text("Underruns: %llu (%llu frames of silence)", static_cast<unsigned long long>(playback.underruns),
+                                static_cast<unsigned long long>(playback.silentFrames));
+                    ImGui::Text("Overruns: %llu (%llu frames dropped)", static_cast<unsigned long long>(playback.overruns),
+                                static_cast<unsigned long long>(playback.droppedFrames));
+                    ImGui::Text("Output: %s, %zu-frame periods, device delay %.1f ms (%s)", m_audioPlayback->Name(),
+                                m_audioPlayback->DeviceFrames(), playback.outputDelayMs,
+                                playback.outputDelayMeasured ? "measured" : "buffer size");
+                    if (playback.deviceXruns > 0) {
+                        ImGui::Text("Device underruns: %llu", static_cast<unsigned long long>(playback.deviceXruns));
+                    }
+                    ImGui::Text("Latency: %.1f ms (target %.1f ms)", playback.latencyMs, playback.targetMs);
+                    ImGui::Text("Clock drift: %+.0f ppm", playback.driftPpm);
+                    ImGui::Text("Resyncs: %llu", static_cast<unsigned long long>(playback.resyncs));
+                    ImGui::Unindent();
+                    ImGui::Spacing();
+
+                    ImGui::Text("A/V sync");
+                    ImGui::Indent();
+                    bool syncEnabled = m_avSync.IsEnabled();
+                    if (ImGui::Checkbox("Hold back the stream that is ahead", &syncEnabled)) {
+                        m_avSync.SetEnabled(syncEnabled);
+                        SaveConfig();
+                    }
+                    int offset = static_cast<int>(std::lround(m_avSync.UserOffset()));
+                    const int maxOffset = static_cast<int>(AvSync::kMaxDelayMs);
+                    ImGui::SetNextItemWidth(200);
+                    if (ImGui::SliderInt("##avoffset", &offset, -maxOffset, maxOffset, "Offset %+d ms")) {
+                        m_avSync.SetUserOffset(offset);
+                    }
+                    // Save config when user releases the slider
+                    if (ImGui::IsItemDeactivatedAfterEdit()) {
+                        SaveConfig();
+                    }
+                    if (ImGui::IsItemHovered()) {
+                        ImGui::SetTooltip("Positive delays audio, negative delays video");
+                    }
+                    AvSyncStats sync = m_avSync.GetStats();
+                    if (sync.measuring) {
+                        ImGui::Text("Audio %.1f ms, video %.1f ms after capture", sync.audioLatencyMs, sync.videoLatencyMs);
+                        ImGui::Text("Holding back %s by %.1f ms", sync.videoDelayMs > 0.0 ? "video" : "audio",
+                                    sync.videoDelayMs > 0.0 ? sync.videoDelayMs : sync.audioDelayMs);
+                    } else {
+                        ImGui::TextDisabled("Waiting for audio and video");
+                    }
+                    ImGui::Unindent();
                 }
             }
             
@@ -477,7 +1046,10 @@ void Application::RestartCapture(int width, int height, int fps) {
     
     // Start new capture
     try {
-        m_video = std::make_unique<VideoCapture>(m_currentDevice, width, height, fps, m_currentFormat, 10);
+        m_video = CreateCapture(m_currentDevice, width, height, fps, m_currentFormat);
+        m_videoDisplay = m_video->Bus().Subscribe("display", FrameDropPolicy::LatestOnly);
+        m_videoTiming.held.clear();
+        m_avSync.Reset();
         m_video->Start();
         
         // Give it a moment to validate it's working
@@ -511,6 +1083,9 @@ void Application::SwitchDevice(const std::string& devicePath) {
         return;
     }
     
+    // The new main device can't also be an extra source
+    RemoveSource(devicePath);
+    
     // Stop current capture safely
     if (m_video) {
         try {
@@ -531,17 +1106,40 @@ void Application::SwitchDevice(const std::string& devicePath) {
     m_currentDevice = devicePath;
     m_availableFormats = std::move(newFormats);
     
-    // Use first available format from the new device
-    m_currentWidth = m_availableFormats[0].width;
-    m_currentHeight = m_availableFormats[0].height;
-    m_currentFps = m_availableFormats[0].fps;
+    // Use first available mode in the current format, otherwise the first
+    // mode in any format we can capture
+    const VideoFormat* chosen = nullptr;
+    for (const auto& format : m_availableFormats) {
+        if (format.pixelFormat == GetPixelFormat(m_currentFormat)) {
+            chosen = &format;
+            break;
+        }
+    }
+    if (!chosen) {
+        for (const auto& format : m_availableFormats) {
+            if (IsCapturableFormat(format.pixelFormat)) {
+                chosen = &format;
+                m_currentFormat = V4L2Capabilities::FormatName(format.pixelFormat);
+                break;
+            }
+        }
+    }
+    if (!chosen) {
+        chosen = &m_availableFormats[0];
+    }
+    m_currentWidth = chosen->width;
+    m_currentHeight = chosen->height;
+    m_currentFps = chosen->fps;
     
     // Recreate decoder for new device
     m_decoder = std::make_unique<MjpgDecoder>();
     
     // Start capture with new device
     try {
-        m_video = std::make_unique<VideoCapture>(m_currentDevice, m_currentWidth, m_currentHeight, m_currentFps, m_currentFormat, 10);
+        m_video = CreateCapture(m_currentDevice, m_currentWidth, m_currentHeight, m_currentFps, m_currentFormat);
+        m_videoDisplay = m_video->Bus().Subscribe("display", FrameDropPolicy::LatestOnly);
+        m_videoTiming.held.clear();
+        m_avSync.Reset();
         m_video->Start();
         
         // Give it a moment to validate it's working
@@ -580,10 +1178,11 @@ void Application::SwitchAudioDevice(const std::string& deviceName) {
     
     // Update device
     m_currentAudioDevice = deviceName;
+    m_avSync.Reset();
     
     // Start capture with new audio device
     try {
-        m_audio = std::make_unique<AudioCapture>(m_currentAudioDevice, 48000, 2, 1024);
+        m_audio = CreateAudioCapture(m_currentAudioDevice);
         m_audio->Start();
         std::cout << "Successfully switched to audio device: " << m_currentAudioDevice << std::endl;
         SaveConfig();
@@ -606,24 +1205,80 @@ void Application::ToggleFullscreen() {
     }
 }
 
-void Application::SaveConfig() {
+void Application::SetWindowVisible(bool visible) {
+    if (visible == m_isVisible) {
+        return;
+    }
+    m_isVisible = visible;
+
+    // Keep the V4L2 stream alive for instant resume, but stop decoding
+    if (m_video) {
+        m_video->SetDecodeEnabled(visible);
+    }
+    for (auto& source : m_extraSources) {
+        source.capture->SetDecodeEnabled(visible);
+    }
+    std::cout << (visible ? "Window visible, resuming video" : "Window hidden, suspending video decode") << std::endl;
+}
+
+void Application::SaveConfig(bool now) {
     m_config.videoDevice = m_currentDevice;
     m_config.audioDevice = m_currentAudioDevice;
     m_config.width = m_currentWidth;
     m_config.height = m_currentHeight;
     m_config.fps = m_currentFps;
     m_config.videoFormat = m_currentFormat;
+    m_config.mjpegBackend = m_currentMjpegBackend;
+    m_config.extraVideoDevices.clear();
+    for (const auto& source : m_extraSources) {
+        if (!m_config.extraVideoDevices.empty()) {
+            m_config.extraVideoDevices += ",";
+        }
+        m_config.extraVideoDevices += source.device;
+    }
+    m_config.layout = m_renderer->GetLayout() == CompositeLayout::PictureInPicture ? "pip" : "grid";
     if (m_audioPlayback) {
         m_config.volume = m_audioPlayback->GetVolume();
     }
-    
-    if (m_config.SaveToFile(m_configPath)) {
-        std::cout << "Config saved" << std::endl;
+    m_config.avSync = m_avSync.IsEnabled();
+    m_config.avSyncOffsetMs = static_cast<int>(std::lround(m_avSync.UserOffset()));
+
+    // Sliders and menus save as they change; the file write stays off the
+    // render loop
+    auto write = [writer = m_configWriter, config = m_config, path = m_configPath,
+                  generation = ++m_configGeneration] {
+        std::lock_guard<std::mutex> lock(writer->mutex);
+        if (generation <= writer->written) {
+            return; // a newer snapshot is already on disk
+        }
+        writer->written = generation;
+        if (config.SaveToFile(path)) {
+            std::cout << "Config saved" << std::endl;
+        }
+    };
+    if (now || !m_jobSystem) {
+        write();
+    } else {
+        m_jobSystem->Submit(JobPriority::Background, std::move(write));
     }
 }
 
 void Application::Render() {
+    if (!m_isVisible) {
+        return;
+    }
+    m_renderer->SetSourceCount(1 + static_cast<int>(m_extraSources.size()));
+    m_renderer->SetSourceSize(0, m_currentWidth, m_currentHeight);
+    for (size_t i = 0; i < m_extraSources.size(); ++i) {
+        m_renderer->SetSourceSize(static_cast<int>(i) + 1, m_extraSources[i].width, m_extraSources[i].height);
+    }
     m_renderer->PreDraw( m_window->GetWidth(), m_window->GetHeight());
+    if (m_video) {
+        m_video->SetDecodeScale(m_renderer->GetDecodeScale(0));
+    }
+    for (size_t i = 0; i < m_extraSources.size(); ++i) {
+        m_extraSources[i].capture->SetDecodeScale(m_renderer->GetDecodeScale(static_cast<int>(i) + 1));
+    }
     m_renderer->Draw();
     RenderUI();
     m_window->SwapBuffers();
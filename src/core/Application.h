@@ -4,17 +4,47 @@
 #include "../graphics/Renderer.h"
 #include "../graphics/Window.h"
 #include "../video/VideoCapture.h"
+#include "../video/DecoderPool.h"
 #include "../video/MjpgDecoder.h"
 #include "../video/V4L2Capabilities.h"
 #include "../audio/AudioCapture.h"
 #include "../audio/AudioPlayback.h"
 #include "../audio/ALSACapabilities.h"
+#include "../audio/PeriodTuner.h"
+#include "AvSync.h"
 #include "Config.h"
+#include "IoReactor.h"
+#include "JobSystem.h"
+#include "Telemetry.h"
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace uvc2gl {
 
+// Arrival timing of the frames one source hands to the renderer
+struct FrameTiming {
+    uint64_t lastTimestamp = 0;   // Capture timestamp of the previous frame (ns)
+    double avgIntervalMs = 0.0;   // Moving average of capture-to-capture spacing
+    double avgUploadAgeMs = 0.0;  // Moving average of capture -> texture upload
+    std::deque<Frame> held;       // Frames waiting out the A/V sync delay
+
+    double Fps() const { return avgIntervalMs > 0.0 ? 1000.0 / avgIntervalMs : 0.0; }
+};
+
+// A capture composited next to the main one
+struct ExtraSource {
+    std::string device;
+    int width = 0;
+    int height = 0;
+    int fps = 0;
+    std::string format;
+    std::unique_ptr<VideoCapture> capture;
+    std::shared_ptr<FrameSubscription> display;
+    FrameTiming timing;
+};
+
 class Application {
 public:
     Application(const char* title, int width, int height);
@@ -35,16 +65,41 @@ private:
     void ShutdownImGui();
     void RestartCapture(int width, int height, int fps);
     void SwitchDevice(const std::string& devicePath);
+    std::unique_ptr<VideoCapture> CreateCapture(const std::string& device, int width, int height, int fps,
+                                                const std::string& format);
+    std::unique_ptr<AudioCapture> CreateAudioCapture(const std::string& device);
+    std::unique_ptr<AudioPlayback> CreateAudioPlayback();
+    // Reopens a device whose xruns pushed its period up
+    void TuneAudioPeriods();
+    bool AddSource(const std::string& devicePath);
+    void RemoveSource(const std::string& devicePath);
+    void PresentFrame(int source, FrameSubscription& display, FrameTiming& timing);
     void SwitchAudioDevice(const std::string& deviceName);
     void ToggleFullscreen();
-    void SaveConfig();
+    void SetWindowVisible(bool visible);
+    // Writes the config from a Background job; now writes it before returning
+    void SaveConfig(bool now = false);
 
     std::unique_ptr<Window> m_window;
     std::unique_ptr<Renderer> m_renderer;
+    std::shared_ptr<IoReactor> m_ioReactor;
+    std::shared_ptr<JobSystem> m_jobSystem;
+    std::shared_ptr<DecoderPool> m_decoderPool;
     std::unique_ptr<VideoCapture> m_video;
+    std::shared_ptr<FrameSubscription> m_videoDisplay;
+    FrameTiming m_videoTiming;
+    std::vector<ExtraSource> m_extraSources;
     std::unique_ptr<MjpgDecoder>  m_decoder;
     std::unique_ptr<AudioCapture> m_audio;
     std::unique_ptr<AudioPlayback> m_audioPlayback;
+    std::unique_ptr<PeriodTuner> m_captureTuner;  // For m_audio's device
+    std::unique_ptr<PeriodTuner> m_outputTuner;   // Direct ALSA output only
+    static constexpr auto kOutputReopenInterval = std::chrono::seconds(2);
+    PeriodTuner::Clock::time_point m_outputReopenTime{};
+    AvSync m_avSync;
+    FramePool m_heldFramePool;  // Copies of device buffers held for the sync delay
+    std::unique_ptr<TelemetryLog> m_telemetry;  // Only with statsLog set
+    int64_t m_lastTelemetryNs = 0;
     
     std::vector<VideoDevice> m_availableDevices;
     std::vector<VideoFormat> m_availableFormats;
@@ -58,10 +113,19 @@ private:
     int m_currentHeight = 1080;
     int m_currentFps = 30;
     std::string m_currentFormat = "YUYV";
+    std::string m_currentMjpegBackend = "ffmpeg";
     bool m_isFullscreen = false;
+    bool m_isVisible = true;
     
     AppConfig m_config;
     std::string m_configPath = "uvc2gl.conf";
+    // Shared with pending config writes: the newest snapshot wins if they overlap
+    struct ConfigWriter {
+        std::mutex mutex;
+        uint64_t written = 0;  // Generation on disk
+    };
+    std::shared_ptr<ConfigWriter> m_configWriter = std::make_shared<ConfigWriter>();
+    uint64_t m_configGeneration = 0;
 
 };
 
@@ -0,0 +1,67 @@
+#include "AvSync.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace uvc2gl {
+
+// Delays only move when the wanted value is this far from the applied one,
+// so measurement noise doesn't keep the audio queue retargeting
+static constexpr double kDeadbandMs = 4.0;
+
+int64_t MonotonicNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static double Smooth(double average, double sample) {
+    return average < 0.0 ? sample : average * 0.95 + sample * 0.05;
+}
+
+void AvSync::OnVideoFrame(int64_t captureTimeNs, int64_t arrivalNs) {
+    if (captureTimeNs <= 0 || arrivalNs < captureTimeNs) {
+        return; // no usable timestamp
+    }
+    m_videoLatencyMs = Smooth(m_videoLatencyMs, (arrivalNs - captureTimeNs) / 1e6);
+}
+
+void AvSync::OnAudioLatency(double milliseconds) {
+    if (milliseconds > 0.0) {
+        m_audioLatencyMs = Smooth(m_audioLatencyMs, milliseconds);
+    }
+}
+
+void AvSync::Reset() {
+    m_audioLatencyMs = -1.0;
+    m_videoLatencyMs = -1.0;
+}
+
+void AvSync::Update() {
+    double wantAudio = 0.0;
+    double wantVideo = 0.0;
+    if (m_enabled && m_audioLatencyMs >= 0.0 && m_videoLatencyMs >= 0.0) {
+        // Positive: audio reaches the user later than the matching frame
+        const double offset = m_audioLatencyMs - m_videoLatencyMs + m_userOffsetMs;
+        wantVideo = std::clamp(offset, 0.0, kMaxDelayMs);
+        wantAudio = std::clamp(-offset, 0.0, kMaxDelayMs);
+    }
+    if (std::abs(wantVideo - m_videoDelayMs) > kDeadbandMs || wantVideo == 0.0) {
+        m_videoDelayMs = wantVideo;
+    }
+    if (std::abs(wantAudio - m_audioDelayMs) > kDeadbandMs || wantAudio == 0.0) {
+        m_audioDelayMs = wantAudio;
+    }
+}
+
+AvSyncStats AvSync::GetStats() const {
+    AvSyncStats stats;
+    stats.measuring = m_audioLatencyMs >= 0.0 && m_videoLatencyMs >= 0.0;
+    stats.audioLatencyMs = std::max(0.0, m_audioLatencyMs);
+    stats.videoLatencyMs = std::max(0.0, m_videoLatencyMs);
+    stats.offsetMs = stats.measuring ? m_audioLatencyMs - m_videoLatencyMs + m_userOffsetMs : 0.0;
+    stats.audioDelayMs = m_audioDelayMs;
+    stats.videoDelayMs = m_videoDelayMs;
+    return stats;
+}
+
+} // namespace uvc2gl
@@ -0,0 +1,63 @@
+#ifndef uvc2gl_AVSYNC_H
+#define uvc2gl_AVSYNC_H
+
+#include <cstdint>
+
+namespace uvc2gl {
+
+// Current CLOCK_MONOTONIC time: what steady_clock reads on Linux, and the
+// clock V4L2 buffers and ALSA period timestamps are stamped with
+int64_t MonotonicNowNs();
+
+struct AvSyncStats {
+    double audioLatencyMs = 0.0; // Capture to output, not counting the sync delay
+    double videoLatencyMs = 0.0; // Capture to texture upload, not counting the sync delay
+    double offsetMs = 0.0;       // How far audio trails video, user offset included
+    double audioDelayMs = 0.0;   // Applied to hold audio back
+    double videoDelayMs = 0.0;   // Applied to hold video back
+    bool measuring = false;      // Both streams have reported
+};
+
+// Lines audio and video up on the monotonic clock. Both report how long
+// their samples take from capture to the user; whichever stream is ahead
+// is then held back by the difference (video frames before upload, audio
+// by a deeper playback queue). Main thread only.
+class AvSync {
+public:
+    // Keep each delay within what the frame hold and playback ring can absorb
+    static constexpr double kMaxDelayMs = 250.0;
+
+    void SetEnabled(bool enabled) { m_enabled = enabled; }
+    bool IsEnabled() const { return m_enabled; }
+
+    // Added to the measured offset: positive delays audio further (e.g. for
+    // a display that adds its own latency the capture can't see)
+    void SetUserOffset(double milliseconds) { m_userOffsetMs = milliseconds; }
+    double UserOffset() const { return m_userOffsetMs; }
+
+    // A frame of the synced source reached the main thread
+    void OnVideoFrame(int64_t captureTimeNs, int64_t arrivalNs);
+    // Capture-to-output latency the audio path would have without our delay
+    void OnAudioLatency(double milliseconds);
+    // Drop the measurements, e.g. when a device changes
+    void Reset();
+
+    // Recomputes the delays; call once per render loop
+    void Update();
+
+    double AudioDelayMs() const { return m_audioDelayMs; }
+    int64_t VideoDelayNs() const { return static_cast<int64_t>(m_videoDelayMs * 1e6); }
+    AvSyncStats GetStats() const;
+
+private:
+    bool m_enabled = true;
+    double m_userOffsetMs = 0.0;
+    double m_audioLatencyMs = -1.0;   // Smoothed; negative until the first report
+    double m_videoLatencyMs = -1.0;
+    double m_audioDelayMs = 0.0;
+    double m_videoDelayMs = 0.0;
+};
+
+} // namespace uvc2gl
+
+#endif // uvc2gl_AVSYNC_H
@@ -12,8 +12,77 @@ struct AppConfig {
     int width = 1920;
     int height = 1080;
     int fps = 30;
-    std::string videoFormat = "MJPEG";  // MJPEG or YUYV
+    std::string videoFormat = "MJPEG";  // MJPEG or a V4L2 FourCC (YUYV, UYVY, NV12, ...)
+    std::string mjpegBackend = "ffmpeg";  // ffmpeg or turbojpeg
     float volume = 1.0f;
+    std::string extraVideoDevices;  // Comma-separated devices composited next to videoDevice
+    std::string layout = "grid";    // grid or pip
+
+    // Thread policies: normal, nice:<n>, fifo:<1-99> or rr:<1-99>, plus an
+    // optional comma-separated core list. Real-time falls back to nice
+    // without privileges.
+    std::string ioThreadPolicy = "fifo:60";     // V4L2/ALSA reactor
+    std::string ioThreadCores;
+    std::string audioThreadPolicy = "fifo:70";  // SDL playback callback
+    std::string audioThreadCores;
+    std::string jobThreadPolicy = "normal";     // Decode workers
+    std::string jobThreadCores;                 // Worker i pinned to the i-th core listed
+    int jobWorkers = 0;                         // 0: one per core
+
+    // Playback queue depth the clock-drift controller holds
+    int audioTargetLatencyMs = 50;
+    std::string audioOutput = "sdl";            // sdl or alsa (direct, low latency)
+    std::string audioOutputDevice = "default";  // ALSA PCM for the alsa output
+
+    // A/V sync: hold back whichever stream is ahead; the offset (ms) is added
+    // on top, positive delaying audio
+    bool avSync = true;
+    int avSyncOffsetMs = 0;
+
+    // Period sizes settled on per ALSA device ("device=frames;..."), capture
+    // and direct output separately; new devices start small
+    std::string audioCapturePeriods;
+    std::string audioOutputPeriods;
+
+    // CSV of video and audio stats, one row per interval; empty disables it
+    std::string statsLog;
+    int statsLogIntervalMs = 1000;
+
+    static int LookupPeriod(const std::string& list, const std::string& device, int fallback) {
+        size_t start = 0;
+        while (start < list.size()) {
+            size_t end = list.find(';', start);
+            if (end == std::string::npos) end = list.size();
+            std::string entry = list.substr(start, end - start);
+            // Device names may contain '=' (plughw:CARD=x), the size never does
+            size_t pos = entry.rfind('=');
+            if (pos != std::string::npos && entry.substr(0, pos) == device) {
+                try {
+                    return std::stoi(entry.substr(pos + 1));
+                } catch (...) {
+                    return fallback;
+                }
+            }
+            start = end + 1;
+        }
+        return fallback;
+    }
+
+    static void StorePeriod(std::string& list, const std::string& device, int frames) {
+        std::string updated;
+        size_t start = 0;
+        while (start < list.size()) {
+            size_t end = list.find(';', start);
+            if (end == std::string::npos) end = list.size();
+            std::string entry = list.substr(start, end - start);
+            size_t pos = entry.rfind('=');
+            if (!entry.empty() && (pos == std::string::npos || entry.substr(0, pos) != device)) {
+                updated += entry + ";";
+            }
+            start = end + 1;
+        }
+        list = updated + device + "=" + std::to_string(frames);
+    }
     
     bool LoadFromFile(const std::string& filename) {
         std::ifstream file(filename);
@@ -36,7 +105,26 @@ struct AppConfig {
             else if (key == "height") height = std::stoi(value);
             else if (key == "fps") fps = std::stoi(value);
             else if (key == "videoFormat") videoFormat = value;
+            else if (key == "mjpegBackend") mjpegBackend = value;
             else if (key == "volume") volume = std::stof(value);
+            else if (key == "extraVideoDevices") extraVideoDevices = value;
+            else if (key == "layout") layout = value;
+            else if (key == "ioThreadPolicy") ioThreadPolicy = value;
+            else if (key == "ioThreadCores") ioThreadCores = value;
+            else if (key == "audioThreadPolicy") audioThreadPolicy = value;
+            else if (key == "audioThreadCores") audioThreadCores = value;
+            else if (key == "jobThreadPolicy") jobThreadPolicy = value;
+            else if (key == "jobThreadCores") jobThreadCores = value;
+            else if (key == "jobWorkers") jobWorkers = std::stoi(value);
+            else if (key == "audioTargetLatencyMs") audioTargetLatencyMs = std::stoi(value);
+            else if (key == "audioOutput") audioOutput = value;
+            else if (key == "audioOutputDevice") audioOutputDevice = value;
+            else if (key == "avSync") avSync = (value == "1" || value == "true");
+            else if (key == "avSyncOffsetMs") avSyncOffsetMs = std::stoi(value);
+            else if (key == "audioCapturePeriods") audioCapturePeriods = value;
+            else if (key == "audioOutputPeriods") audioOutputPeriods = value;
+            else if (key == "statsLog") statsLog = value;
+            else if (key == "statsLogIntervalMs") statsLogIntervalMs = std::stoi(value);
         }
         
         file.close();
@@ -59,7 +147,26 @@ struct AppConfig {
         file << "height=" << height << "\n";
         file << "fps=" << fps << "\n";
         file << "videoFormat=" << videoFormat << "\n";
+        file << "mjpegBackend=" << mjpegBackend << "\n";
         file << "volume=" << volume << "\n";
+        file << "extraVideoDevices=" << extraVideoDevices << "\n";
+        file << "layout=" << layout << "\n";
+        file << "ioThreadPolicy=" << ioThreadPolicy << "\n";
+        file << "ioThreadCores=" << ioThreadCores << "\n";
+        file << "audioThreadPolicy=" << audioThreadPolicy << "\n";
+        file << "audioThreadCores=" << audioThreadCores << "\n";
+        file << "jobThreadPolicy=" << jobThreadPolicy << "\n";
+        file << "jobThreadCores=" << jobThreadCores << "\n";
+        file << "jobWorkers=" << jobWorkers << "\n";
+        file << "audioTargetLatencyMs=" << audioTargetLatencyMs << "\n";
+        file << "audioOutput=" << audioOutput << "\n";
+        file << "audioOutputDevice=" << audioOutputDevice << "\n";
+        file << "avSync=" << (avSync ? 1 : 0) << "\n";
+        file << "avSyncOffsetMs=" << avSyncOffsetMs << "\n";
+        file << "audioCapturePeriods=" << audioCapturePeriods << "\n";
+        file << "audioOutputPeriods=" << audioOutputPeriods << "\n";
+        file << "statsLog=" << statsLog << "\n";
+        file << "statsLogIntervalMs=" << statsLogIntervalMs << "\n";
         
         file.close();
         return true;
@@ -0,0 +1,148 @@
+#include "IoReactor.h"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace uvc2gl {
+
+// epoll user data of the wakeup eventfd; registrations start at 1
+static constexpr uint64_t kWakeId = 0;
+
+IoReactor::IoReactor(const ThreadPolicy& policy) {
+    m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0) {
+        throw std::runtime_error("Failed to create epoll instance: " + std::string(strerror(errno)));
+    }
+    m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_wakeFd < 0) {
+        close(m_epollFd);
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = kWakeId;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &event) < 0) {
+        close(m_wakeFd);
+        close(m_epollFd);
+        throw std::runtime_error("Failed to watch eventfd: " + std::string(strerror(errno)));
+    }
+
+    m_running = true;
+    m_thread = std::thread(&IoReactor::Loop, this, policy);
+}
+
+IoReactor::~IoReactor() {
+    try {
+        m_running = false;
+        uint64_t one = 1;
+        if (write(m_wakeFd, &one, sizeof(one)) < 0) {
+            std::cerr << "Failed to wake I/O reactor: " << strerror(errno) << std::endl;
+        }
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    } catch (...) {
+        // Never throw from destructor
+        std::cerr << "Exception in IoReactor destructor" << std::endl;
+    }
+    close(m_wakeFd);
+    close(m_epollFd);
+}
+
+int IoReactor::Add(int fd, uint32_t events, Handler handler) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int id = m_nextId++;
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = static_cast<uint64_t>(id);
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+        std::cerr << "Failed to watch fd " << fd << ": " << strerror(errno) << std::endl;
+        return -1;
+    }
+    m_registrations[id] = std::make_shared<Registration>(Registration{ fd, std::move(handler) });
+    return id;
+}
+
+bool IoReactor::Modify(int id, uint32_t events) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_registrations.find(id);
+    if (it == m_registrations.end()) {
+        return false;
+    }
+    epoll_event event{};
+    event.events = events;
+    event.data.u64 = static_cast<uint64_t>(id);
+    return epoll_ctl(m_epollFd, EPOLL_CTL_MOD, it->second->fd, &event) == 0;
+}
+
+void IoReactor::Remove(int id) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto it = m_registrations.find(id);
+    if (it != m_registrations.end()) {
+        epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+        m_registrations.erase(it);
+    }
+    if (!InReactorThread()) {
+        m_idle.wait(lock, [this, id] { return m_dispatching != id; });
+    }
+}
+
+void IoReactor::Loop(ThreadPolicy policy) {
+    ApplyThreadPolicy("uvc2gl-io", policy);
+
+    epoll_event events[16];
+    while (m_running.load()) {
+        int count = epoll_wait(m_epollFd, events, 16, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "I/O reactor wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count && m_running.load(); ++i) {
+            if (events[i].data.u64 == kWakeId) {
+                uint64_t value;
+                while (read(m_wakeFd, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+
+            // Look the id up again: an earlier handler in this batch may
+            // have removed it
+            const int id = static_cast<int>(events[i].data.u64);
+            std::shared_ptr<Registration> registration;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                auto it = m_registrations.find(id);
+                if (it == m_registrations.end()) {
+                    continue;
+                }
+                registration = it->second;
+                m_dispatching = id;
+            }
+
+            try {
+                registration->handler(events[i].events);
+            } catch (const std::exception& e) {
+                std::cerr << "I/O handler error: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Unknown I/O handler error" << std::endl;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_dispatching = 0;
+            }
+            m_idle.notify_all();
+        }
+    }
+}
+
+} // namespace uvc2gl
@@ -0,0 +1,65 @@
+#ifndef uvc2gl_IOREACTOR_H
+#define uvc2gl_IOREACTOR_H
+
+#include "ThreadPolicy.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace uvc2gl {
+
+// One epoll thread that waits on every device fd (V4L2 buffers, ALSA poll
+// descriptors, eventfds) and calls the registered handler when one is
+// ready. Handlers run on the reactor thread one at a time, so they must only
+// do the non-blocking part of the work (dequeue, read) and hand anything
+// heavy to a worker pool.
+class IoReactor {
+public:
+    // Called with the epoll events that fired (EPOLLIN, EPOLLERR, ...)
+    using Handler = std::function<void(uint32_t events)>;
+
+    // The reactor thread applies policy when it starts
+    explicit IoReactor(const ThreadPolicy& policy = {});
+    ~IoReactor();
+
+    IoReactor(const IoReactor&) = delete;
+    IoReactor& operator=(const IoReactor&) = delete;
+
+    // Level-triggered registration; returns an id for Modify/Remove, or -1
+    int Add(int fd, uint32_t events, Handler handler);
+    bool Modify(int id, uint32_t events);
+    // Once this returns the handler is not running and never runs again.
+    // From inside a handler it only unregisters (the reactor thread can't
+    // wait for itself).
+    void Remove(int id);
+
+    bool InReactorThread() const { return std::this_thread::get_id() == m_thread.get_id(); }
+
+private:
+    struct Registration {
+        int fd;
+        Handler handler;
+    };
+
+    void Loop(ThreadPolicy policy);
+
+    int m_epollFd = -1;
+    int m_wakeFd = -1;
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    std::mutex m_mutex;
+    std::condition_variable m_idle;
+    std::unordered_map<int, std::shared_ptr<Registration>> m_registrations;
+    int m_nextId = 1;
+    int m_dispatching = 0; // Id whose handler is running, 0 if none
+};
+
+} // namespace uvc2gl
+
+#endif // uvc2gl_IOREACTOR_H
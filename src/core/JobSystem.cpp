@@ -0,0 +1,224 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+namespace uvc2gl {
+
+// Worker the current thread belongs to, so Submit from inside a job stays local
+static thread_local const JobSystem* t_system = nullptr;
+static thread_local size_t t_worker = 0;
+
+// Busy percentage is measured over windows of this length
+static constexpr auto kStatsWindow = std::chrono::milliseconds(500);
+
+JobSystem::JobSystem(size_t workers, const ThreadPolicy& policy) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_workers.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workers; ++i) {
+        ThreadPolicy workerPolicy = policy;
+        if (!policy.cores.empty()) {
+            workerPolicy.cores = { policy.cores[i % policy.cores.size()] };
+        }
+        m_workers[i]->thread = std::thread(&JobSystem::WorkerLoop, this, i, workerPolicy);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker : m_workers) {
+        try {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        } catch (...) {
+            std::cerr << "Error joining job worker" << std::endl;
+        }
+    }
+    // Jobs still queued are dropped with whatever they captured
+}
+
+void JobSystem::Submit(JobPriority priority, Job job) {
+    size_t target = (t_system == this) ? t_worker
+                                        : m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    {
+        Worker& worker = *m_workers[target];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[static_cast<size_t>(priority)].push_back(std::move(job));
+    }
+    m_pending.fetch_add(1);
+    {
+        // Pairs with the predicate check in WorkerLoop so the wakeup isn't lost
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+    }
+    m_wake.notify_one();
+}
+
+bool JobSystem::TakeJob(size_t self, Job& job, bool& stolen) {
+    const size_t count = m_workers.size();
+    for (size_t p = 0; p < kJobPriorityCount; ++p) {
+        // Own queue first, then the others starting with the next worker
+        for (size_t n = 0; n < count; ++n) {
+            Worker& worker = *m_workers[(self + n) % count];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            auto& queue = worker.queues[p];
+            if (queue.empty()) {
+                continue;
+            }
+            if (n == 0) {
+                job = std::move(queue.front());
+                queue.pop_front();
+            } else {
+                // Steal from the far end, away from what the owner runs next
+                job = std::move(queue.back());
+                queue.pop_back();
+            }
+            stolen = (n != 0);
+            m_pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::RunOne(size_t self) {
+    Job job;
+    bool stolen = false;
+    if (!TakeJob(self, job, stolen)) {
+        return false;
+    }
+    try {
+        job();
+    } catch (const std::exception& e) {
+        std::cerr << "Job failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Job failed" << std::endl;
+    }
+    if (t_system == this && t_worker == self) {
+        Worker& worker = *m_workers[self];
+        worker.executed.fetch_add(1, std::memory_order_relaxed);
+        if (stolen) {
+            worker.stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    return true;
+}
+
+void JobSystem::WorkerLoop(size_t index, ThreadPolicy policy) {
+    t_system = this;
+    t_worker = index;
+    Worker& worker = *m_workers[index];
+    AppliedThreadPolicy applied = ApplyThreadPolicy("uvc2gl-job" + std::to_string(index), policy);
+    if (!applied.applied.cores.empty()) {
+        worker.core.store(applied.applied.cores.front(), std::memory_order_relaxed);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point windowStart = Clock::now();
+    Clock::duration busy{};
+    auto updateBusy = [&](Clock::time_point now) {
+        if (now - windowStart < kStatsWindow) {
+            return;
+        }
+        double percent = 100.0 * std::chrono::duration<double>(busy).count() /
+                         std::chrono::duration<double>(now - windowStart).count();
+        double avg = worker.busyPercent.load(std::memory_order_relaxed);
+        worker.busyPercent.store(avg * 0.5 + percent * 0.5, std::memory_order_relaxed);
+        windowStart = now;
+        busy = {};
+    };
+
+    while (!m_stopping.load()) {
+        Clock::time_point start = Clock::now();
+        if (RunOne(index)) {
+            Clock::time_point end = Clock::now();
+            busy += end - start;
+            updateBusy(end);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_wake.wait_for(lock, kStatsWindow, [this] { return m_stopping.load() || m_pending.load() > 0; });
+        lock.unlock();
+        updateBusy(Clock::now());
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, const std::function<void(size_t)>& fn, JobPriority priority) {
+    if (count == 0) {
+        return;
+    }
+
+    struct State {
+        const std::function<void(size_t)>* fn;
+        size_t count;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+    };
+    auto state = std::make_shared<State>();
+    state->fn = &fn;
+    state->count = count;
+
+    // fn is only touched after claiming an index, and ParallelFor can't
+    // return before every claimed index is done, so late helpers are safe
+    auto drain = [](State& s) {
+        size_t i;
+        while ((i = s.next.fetch_add(1)) < s.count) {
+            try {
+                (*s.fn)(i);
+            } catch (const std::exception& e) {
+                std::cerr << "Parallel job failed: " << e.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Parallel job failed" << std::endl;
+            }
+            s.done.fetch_add(1);
+        }
+    };
+
+    const size_t helpers = std::min(count, m_workers.size()) - 1;
+    for (size_t h = 0; h < helpers; ++h) {
+        Submit(priority, [state, drain] { drain(*state); });
+    }
+    drain(*state);
+
+    // Help with other work rather than block a worker the helpers may need
+    const bool onWorker = (t_system == this);
+    while (state->done.load() < count) {
+        if (!(onWorker && RunOne(t_worker))) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+std::vector<JobWorkerStats> JobSystem::GetStats() const {
+    std::vector<JobWorkerStats> stats;
+    stats.reserve(m_workers.size());
+    for (const auto& worker : m_workers) {
+        JobWorkerStats s;
+        s.core = worker->core.load(std::memory_order_relaxed);
+        s.executed = worker->executed.load(std::memory_order_relaxed);
+        s.stolen = worker->stolen.load(std::memory_order_relaxed);
+        s.busyPercent = worker->busyPercent.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> lock(worker->mutex);
+            for (const auto& queue : worker->queues) {
+                s.queued += queue.size();
+            }
+        }
+        stats.push_back(s);
+    }
+    return stats;
+}
+
+} // namespace uvc2gl
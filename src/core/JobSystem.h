@@ -0,0 +1,93 @@
+#ifndef uvc2gl_JOBSYSTEM_H
+#define uvc2gl_JOBSYSTEM_H
+
+#include "ThreadPolicy.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace uvc2gl {
+
+// Higher classes always run first. Within a class a worker runs its own
+// queue oldest first, while idle workers steal the newest job, so there is
+// no order across workers. Audio has no class: capture and output run on
+// the reactor and their own thread, never queued behind decode.
+enum class JobPriority {
+    VideoDecode = 0, // Decode and pixel conversion
+    Background = 1,  // Anything that can wait (config saves)
+};
+constexpr size_t kJobPriorityCount = 2;
+
+struct JobWorkerStats {
+    int core = -1;                 // Pinned core, -1 if not pinned (or pinning was denied)
+    uint64_t executed = 0;         // Jobs run on this worker
+    uint64_t stolen = 0;           // ... of which were taken from another worker's queue
+    size_t queued = 0;             // Waiting in this worker's queue right now
+    double busyPercent = 0.0;      // Time spent running jobs, smoothed
+};
+
+// Process-wide pool of one worker per core. Each worker has its own queue
+// per priority; idle workers steal from the others, so jobs submitted from
+// one thread still spread over every core, and CPU-heavy stages share the
+// cores instead of each bringing threads of their own.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // workers == 0 picks one per core. Every worker applies policy; if it
+    // lists cores, worker i is pinned to the i-th of them (wrapping).
+    explicit JobSystem(size_t workers = 0, const ThreadPolicy& policy = {});
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // From a worker the job goes to that worker's queue (others steal it
+    // if they are idle); from any other thread the workers take turns
+    void Submit(JobPriority priority, Job job);
+
+    // Runs fn(i) for i in [0, count) across the workers and returns when
+    // all are done. The calling thread takes part, so it is safe from
+    // inside a job.
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn,
+                     JobPriority priority = JobPriority::VideoDecode);
+
+    size_t WorkerCount() const { return m_workers.size(); }
+    std::vector<JobWorkerStats> GetStats() const;
+
+private:
+    struct Worker {
+        mutable std::mutex mutex;
+        std::deque<Job> queues[kJobPriorityCount];
+        std::thread thread;
+        std::atomic<int> core{-1};
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<double> busyPercent{0.0};
+    };
+
+    void WorkerLoop(size_t index, ThreadPolicy policy);
+    // Pops the most urgent job, own queue before stealing; false if none
+    bool TakeJob(size_t self, Job& job, bool& stolen);
+    bool RunOne(size_t self);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_nextWorker{0};
+
+    // Sleeping workers wait here; m_pending counts queued jobs
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wake;
+    std::atomic<size_t> m_pending{0};
+    std::atomic<bool> m_stopping{false};
+};
+
+} // namespace uvc2gl
+
+#endif // uvc2gl_JOBSYSTEM_H
@@ -0,0 +1,66 @@
+#include "Telemetry.h"
+#include <iomanip>
+#include <stdexcept>
+
+namespace uvc2gl {
+
+TelemetryLog::TelemetryLog(const std::string& path)
+    : m_path(path)
+    , m_file(path, std::ios::out | std::ios::trunc)
+{
+    if (!m_file.is_open()) {
+        throw std::runtime_error("Cannot open stats log " + path);
+    }
+    m_file << "time_s,"
+           << "video_captured,video_decoded,video_duplicate,video_failed,video_overrun,"
+           << "video_fps,video_capture_latency_ms,video_decode_ms,video_upload_age_ms,"
+           << "audio_periods,audio_periods_dropped,audio_capture_xruns,audio_short_reads,audio_capture_latency_ms,"
+           << "playback_queued_frames,playback_fill_pct,playback_queue_ms,playback_device_delay_ms,"
+           << "playback_target_ms,playback_underruns,playback_overruns,playback_dropped_frames,"
+           << "playback_silent_frames,playback_device_xruns,playback_resyncs,playback_drift_ppm,"
+           << "audio_latency_ms,av_offset_ms,av_audio_delay_ms,av_video_delay_ms\n";
+    m_file.flush();
+}
+
+void TelemetryLog::Write(const TelemetrySample& sample) {
+    if (m_startNs == 0) {
+        m_startNs = sample.timeNs;
+    }
+
+    // Empty fields for a side that isn't running, so plots show a gap
+    // rather than zeros
+    m_file << std::fixed << std::setprecision(3) << (sample.timeNs - m_startNs) / 1e9 << ',';
+    if (sample.hasVideo) {
+        const CaptureStats& v = sample.video;
+        m_file << v.framesCaptured << ',' << v.framesDecoded << ',' << v.framesDuplicate << ','
+               << v.framesFailed << ',' << v.framesOverrun << ','
+               << std::setprecision(2) << sample.videoFps << ',' << v.avgCaptureLatencyMs << ','
+               << v.avgDecodeMs << ',' << sample.videoUploadAgeMs << ',';
+    } else {
+        m_file << ",,,,,,,,,";
+    }
+    if (sample.hasAudio) {
+        const AudioCaptureStats& c = sample.capture;
+        const PlaybackStats& p = sample.playback;
+        m_file << c.periodsCaptured << ',' << c.periodsDropped << ',' << c.xruns << ',' << c.shortReads << ','
+               << std::setprecision(2) << c.avgLatencyMs << ','
+               << p.queuedFrames << ',' << p.FillPercent() << ',' << sample.AudioQueueMs() << ','
+               << p.outputDelayMs << ',' << p.targetMs << ','
+               << p.underruns << ',' << p.overruns << ',' << p.droppedFrames << ','
+               << p.silentFrames << ',' << p.deviceXruns << ',' << p.resyncs << ','
+               << std::setprecision(0) << p.driftPpm << ','
+               << std::setprecision(2) << sample.AudioLatencyMs() << ',';
+    } else {
+        m_file << ",,,,,,,,,,,,,,,,,,";
+    }
+    if (sample.sync.measuring) {
+        m_file << sample.sync.offsetMs << ',' << sample.sync.audioDelayMs << ',' << sample.sync.videoDelayMs;
+    } else {
+        m_file << ",,";
+    }
+    m_file << '\n';
+    // A row a second at most: flushing keeps the file useful after a crash
+    m_file.flush();
+}
+
+} // namespace uvc2gl
@@ -0,0 +1,59 @@
+#ifndef uvc2gl_TELEMETRY_H
+#define uvc2gl_TELEMETRY_H
+
+#include "../audio/AudioCapture.h"
+#include "../audio/AudioPlayback.h"
+#include "../video/CaptureStats.h"
+#include "AvSync.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+namespace uvc2gl {
+
+// Video and audio stats taken at the same moment, so a stall on one side
+// can be lined up with what the other was doing
+struct TelemetrySample {
+    int64_t timeNs = 0;             // CLOCK_MONOTONIC
+
+    bool hasVideo = false;
+    CaptureStats video;             // Main source
+    double videoFps = 0.0;
+    double videoUploadAgeMs = 0.0;  // Capture to texture upload
+
+    bool hasAudio = false;          // Both capture and playback running
+    AudioCaptureStats capture;
+    PlaybackStats playback;
+
+    AvSyncStats sync;
+
+    // Capture to output as measured: capture-side delay, the queue and the device
+    double AudioLatencyMs() const { return capture.avgLatencyMs + playback.latencyMs; }
+    // Queued between capture and the device (ring and resampler)
+    double AudioQueueMs() const { return playback.latencyMs - playback.outputDelayMs; }
+};
+
+// Appends samples to a CSV file, one row each with a header row first.
+// Counters are cumulative since their device was opened; diff successive
+// rows for rates. Main thread only.
+class TelemetryLog {
+public:
+    // Throws if the file can't be opened
+    explicit TelemetryLog(const std::string& path);
+
+    TelemetryLog(const TelemetryLog&) = delete;
+    TelemetryLog& operator=(const TelemetryLog&) = delete;
+
+    void Write(const TelemetrySample& sample);
+
+    const std::string& Path() const { return m_path; }
+
+private:
+    std::string m_path;
+    std::ofstream m_file;
+    int64_t m_startNs = 0;  // First sample's time; rows are stamped relative to it
+};
+
+} // namespace uvc2gl
+
+#endif // uvc2gl_TELEMETRY_H
@@ -0,0 +1,158 @@
+#include "ThreadPolicy.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace uvc2gl {
+
+static std::mutex s_reportMutex;
+static std::vector<AppliedThreadPolicy> s_report;
+
+ThreadPolicy ThreadPolicy::Parse(const std::string& policy, const std::string& cores) {
+    ThreadPolicy result;
+    std::string kind = policy.substr(0, policy.find(':'));
+    int value = 0;
+    if (policy.find(':') != std::string::npos) {
+        try {
+            value = std::stoi(policy.substr(policy.find(':') + 1));
+        } catch (...) {
+            std::cerr << "Invalid thread policy value: " << policy << std::endl;
+        }
+    }
+
+    if (kind == "fifo" || kind == "rr") {
+        result.sched = (kind == "fifo") ? SchedClass::Fifo : SchedClass::RoundRobin;
+        result.priority = std::clamp(value, 1, 99);
+    } else if (kind == "nice") {
+        result.nice = std::clamp(value, -20, 19);
+    } else if (!kind.empty() && kind != "normal") {
+        std::cerr << "Unknown thread policy '" << policy << "', using normal" << std::endl;
+    }
+
+    std::stringstream list(cores);
+    std::string core;
+    while (std::getline(list, core, ',')) {
+        try {
+            if (!core.empty()) {
+                result.cores.push_back(std::stoi(core));
+            }
+        } catch (...) {
+            std::cerr << "Invalid core in thread policy: " << core << std::endl;
+        }
+    }
+    return result;
+}
+
+std::string ThreadPolicy::ToString() const {
+    std::string text;
+    switch (sched) {
+        case SchedClass::Fifo: text = "fifo:" + std::to_string(priority); break;
+        case SchedClass::RoundRobin: text = "rr:" + std::to_string(priority); break;
+        case SchedClass::Normal: text = nice != 0 ? "nice:" + std::to_string(nice) : "normal"; break;
+    }
+    if (!cores.empty()) {
+        text += " cores ";
+        for (size_t i = 0; i < cores.size(); ++i) {
+            text += (i ? "," : "") + std::to_string(cores[i]);
+        }
+    }
+    return text;
+}
+
+// Nice levels are per thread on Linux when addressed by tid
+static bool SetNice(int tid, int nice) {
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) == 0;
+}
+
+AppliedThreadPolicy ApplyThreadPolicy(const std::string& name, const ThreadPolicy& policy) {
+    AppliedThreadPolicy result;
+    result.name = name;
+    result.tid = static_cast<int>(gettid());
+    result.requested = policy;
+    std::string notes;
+    auto note = [&notes](const std::string& text) { notes += (notes.empty() ? "" : "; ") + text; };
+
+    // Kernel limit is 15 characters plus the terminator
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+    ThreadPolicy& applied = result.applied;
+    if (policy.sched != SchedClass::Normal) {
+        sched_param param{};
+        param.sched_priority = policy.priority;
+        int sched = (policy.sched == SchedClass::Fifo) ? SCHED_FIFO : SCHED_RR;
+        int err = pthread_setschedparam(pthread_self(), sched, &param);
+        if (err == 0) {
+            applied.sched = policy.sched;
+            applied.priority = policy.priority;
+        } else {
+            // Unprivileged: the best we can do is the highest nice level allowed
+            note(std::string(policy.sched == SchedClass::Fifo ? "SCHED_FIFO" : "SCHED_RR") + " denied (" +
+                 strerror(err) + ")");
+            for (int nice = -20; nice <= 0; ++nice) {
+                if (SetNice(result.tid, nice)) {
+                    applied.nice = nice;
+                    break;
+                }
+            }
+        }
+    } else if (policy.nice != 0) {
+        if (SetNice(result.tid, policy.nice)) {
+            applied.nice = policy.nice;
+        } else {
+            note("nice " + std::to_string(policy.nice) + " denied (" + strerror(errno) + ")");
+        }
+    }
+
+    if (!policy.cores.empty()) {
+        const int online = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int core : policy.cores) {
+            if (core >= 0 && core < online && core < CPU_SETSIZE) {
+                CPU_SET(core, &set);
+                applied.cores.push_back(core);
+            }
+        }
+        if (applied.cores.size() != policy.cores.size()) {
+            note("cores beyond the " + std::to_string(online) + " online ignored");
+        }
+        if (!applied.cores.empty()) {
+            int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            if (err != 0) {
+                note(std::string("affinity denied (") + strerror(err) + ")");
+                applied.cores.clear();
+            }
+        }
+    }
+
+    result.note = notes;
+    std::cout << "Thread " << name << " (" << result.tid << "): " << applied.ToString();
+    if (!notes.empty()) {
+        std::cout << " [" << notes << "]";
+    }
+    std::cout << std::endl;
+
+    std::lock_guard<std::mutex> lock(s_reportMutex);
+    auto it = std::find_if(s_report.begin(), s_report.end(),
+                           [&name](const AppliedThreadPolicy& entry) { return entry.name == name; });
+    if (it != s_report.end()) {
+        *it = result;
+    } else {
+        s_report.push_back(result);
+    }
+    return result;
+}
+
+std::vector<AppliedThreadPolicy> ThreadPolicyReport() {
+    std::lock_guard<std::mutex> lock(s_reportMutex);
+    return s_report;
+}
+
+} // namespace uvc2gl
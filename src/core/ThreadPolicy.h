@@ -0,0 +1,47 @@
+#ifndef uvc2gl_THREADPOLICY_H
+#define uvc2gl_THREADPOLICY_H
+
+#include <string>
+#include <vector>
+
+namespace uvc2gl {
+
+enum class SchedClass {
+    Normal,     // SCHED_OTHER with a nice level
+    Fifo,       // SCHED_FIFO
+    RoundRobin  // SCHED_RR
+};
+
+// What a pipeline thread asks for. Text form (config): "normal", "nice:<n>",
+// "fifo:<priority>" or "rr:<priority>"; cores as a comma-separated list.
+struct ThreadPolicy {
+    SchedClass sched = SchedClass::Normal;
+    int priority = 0;       // 1..99 for Fifo/RoundRobin
+    int nice = 0;           // Normal only
+    std::vector<int> cores; // Empty: any core
+
+    static ThreadPolicy Parse(const std::string& policy, const std::string& cores = "");
+    std::string ToString() const;
+};
+
+// What a thread actually got; without CAP_SYS_NICE / RLIMIT_RTPRIO a
+// real-time request falls back to the lowest nice level allowed
+struct AppliedThreadPolicy {
+    std::string name;
+    int tid = 0;
+    ThreadPolicy requested;
+    ThreadPolicy applied;
+    std::string note; // Why applied differs from requested, empty if it doesn't
+};
+
+// Names the calling thread and applies the policy to it, falling back
+// step by step (real-time -> nice -> unchanged) when not permitted. Never
+// throws; the result is also recorded for ThreadPolicyReport().
+AppliedThreadPolicy ApplyThreadPolicy(const std::string& name, const ThreadPolicy& policy);
+
+// Latest result per thread name, in the order threads first applied one
+std::vector<AppliedThreadPolicy> ThreadPolicyReport();
+
+} // namespace uvc2gl
+
+#endif // uvc2gl_THREADPOLICY_H
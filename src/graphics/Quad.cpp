@@ -48,4 +48,10 @@ namespace uvc2gl {
         __glewBindVertexArray(0);
     }
 
+    void Quad::DrawInstanced(int count) const{
+        __glewBindVertexArray(m_VAO);
+        __glewDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+        __glewBindVertexArray(0);
+    }
+
 } // namespace uvc2gl
\ No newline at end of file
@@ -16,6 +16,9 @@ namespace uvc2gl {
             Quad& operator=(const Quad&) = delete;
 
             void Draw() const;
+            // Draws the quad count times in one call; the vertex shader
+            // places each copy using gl_InstanceID
+            void DrawInstanced(int count) const;
 
         private:
             GLuint m_VAO;
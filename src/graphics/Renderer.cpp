@@ -1,5 +1,6 @@
 #include "Renderer.h"
 #include <SDL2/SDL_opengl.h>
+#include <algorithm>
 #include <iostream>
 
 static void InitTexture(GLuint& tex) {
@@ -14,6 +15,114 @@ static void InitTexture(GLuint& tex) {
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 }
 
+// GL description of one Frame plane as a texture
+struct PlaneTexture {
+    GLint internalFormat;
+    GLenum format;
+    GLenum type;
+    int texelBytes;
+};
+
+static int PlaneTextures(uvc2gl::FrameFormat format, PlaneTexture (&textures)[uvc2gl::kMaxFramePlanes]) {
+    using uvc2gl::FrameFormat;
+    switch (format) {
+        case FrameFormat::RGB24:
+            textures[0] = { GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE, 3 };
+            return 1;
+        case FrameFormat::NV12:
+        case FrameFormat::NV16:
+            textures[0] = { GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1 };
+            textures[1] = { GL_RG8, GL_RG, GL_UNSIGNED_BYTE, 2 };
+            return 2;
+        case FrameFormat::P010:
+            // 10-bit samples stay 16-bit: normalised by GL, rescaled in the shader
+            textures[0] = { GL_R16, GL_RED, GL_UNSIGNED_SHORT, 2 };
+            textures[1] = { GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 4 };
+            return 2;
+        case FrameFormat::Y210:
+            // Packed Y0 Cb Y1 Cr: one RG16 texel per pixel, R = Y, G = Cb or Cr
+            textures[0] = { GL_RG16, GL_RG, GL_UNSIGNED_SHORT, 4 };
+            return 1;
+        case FrameFormat::I420:
+        case FrameFormat::I422:
+            textures[0] = textures[1] = textures[2] = { GL_R8, GL_RED, GL_UNSIGNED_BYTE, 1 };
+            return 3;
+    }
+    return 0;
+}
+
+// (Re)allocates the texture when realloc is set, otherwise updates it in place.
+// The plane's stride goes to GL_UNPACK_ROW_LENGTH so padded rows (V4L2
+// buffers, AVFrames) upload without repacking.
+static bool UploadPlane(GLuint& tex, const PlaneTexture& desc, const uvc2gl::FramePlane& plane, bool realloc) {
+    if (!plane.data || plane.stride % desc.texelBytes != 0 || plane.rowBytes % desc.texelBytes != 0) {
+        return false;
+    }
+    if (tex == 0) {
+        InitTexture(tex);
+        realloc = true;
+    }
+    const int width = plane.rowBytes / desc.texelBytes;
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, plane.stride / desc.texelBytes);
+    if (realloc) {
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.internalFormat, width, plane.rows, 0, desc.format, desc.type, plane.data);
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, plane.rows, desc.format, desc.type, plane.data);
+    }
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    return true;
+}
+
+
+// Pixel rectangle of one tile, origin bottom-left like glViewport
+struct TileRect {
+    float x, y, width, height;
+};
+
+// The cell each source gets before its aspect ratio is applied
+static void LayoutCells(uvc2gl::CompositeLayout layout, int count, int width, int height, TileRect* cells) {
+    if (layout == uvc2gl::CompositeLayout::PictureInPicture) {
+        // Main source full window, the rest a quarter size along the bottom right
+        cells[0] = { 0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height) };
+        const float margin = 16.0f;
+        const float insetWidth = width / 4.0f;
+        const float insetHeight = height / 4.0f;
+        for (int i = 1; i < count; ++i) {
+            cells[i] = { width - i * (insetWidth + margin), margin, insetWidth, insetHeight };
+        }
+        return;
+    }
+
+    int columns = 1;
+    while (columns * columns < count) {
+        ++columns;
+    }
+    const int rows = (count + columns - 1) / columns;
+    const float cellWidth = static_cast<float>(width) / columns;
+    const float cellHeight = static_cast<float>(height) / rows;
+    for (int i = 0; i < count; ++i) {
+        const int column = i % columns;
+        const int row = i / columns;
+        cells[i] = { column * cellWidth, height - (row + 1) * cellHeight, cellWidth, cellHeight };
+    }
+}
+
+// Largest rectangle of the given aspect ratio centred in the cell
+// (pillarbox or letterbox bars are left at the clear colour)
+static TileRect FitAspect(const TileRect& cell, float aspect) {
+    TileRect tile = cell;
+    const float cellAspect = cell.width / cell.height;
+    if (cellAspect > aspect) {
+        tile.width = cell.height * aspect;
+        tile.x += (cell.width - tile.width) / 2.0f;
+    } else if (cellAspect < aspect) {
+        tile.height = cell.width / aspect;
+        tile.y += (cell.height - tile.height) / 2.0f;
+    }
+    return tile;
+}
+
 
 namespace uvc2gl {    
 
@@ -23,7 +132,11 @@ Renderer::Renderer() {
     glDisable(GL_DEPTH_TEST);
 }
 
-Renderer::~Renderer() = default;
+Renderer::~Renderer() {
+    for (auto& source : m_sources) {
+        glDeleteTextures(kMaxFramePlanes, source.planeTextures);
+    }
+}
 
 void Renderer::PrintOpenGLVersion() {
     std::cout << "Vendor: " << glGetString(GL_VENDOR) << std::endl;
@@ -33,98 +146,187 @@ void Renderer::PrintOpenGLVersion() {
 }
 
 void Renderer::PreDraw(int width, int height) {
-    // Calculate viewport to maintain video aspect ratio
-    float targetAspect = GetVideoAspectRatio();
-    if (targetAspect <= 0.0f) {
-        // No video loaded yet, default to 16:9
-        targetAspect = 16.0f / 9.0f;
-    }
-    
-    float windowAspect = static_cast<float>(width) / static_cast<float>(height);
-    
-    int viewportX = 0;
-    int viewportY = 0;
-    int viewportWidth = width;
-    int viewportHeight = height;
-    
-    if (windowAspect > targetAspect) {
-        // Window is too wide, add pillarbox (black bars on sides)
-        viewportWidth = static_cast<int>(height * targetAspect);
-        viewportX = (width - viewportWidth) / 2;
-    } else if (windowAspect < targetAspect) {
-        // Window is too tall, add letterbox (black bars on top/bottom)
-        viewportHeight = static_cast<int>(width / targetAspect);
-        viewportY = (height - viewportHeight) / 2;
-    }
-    
-    glViewport(viewportX, viewportY, viewportWidth, viewportHeight);
+    if (width <= 0 || height <= 0) {
+        return;
+    }
+
+    TileRect cells[kMaxVideoSources];
+    LayoutCells(m_layout, m_sourceCount, width, height, cells);
+    for (int i = 0; i < m_sourceCount; ++i) {
+        SourceState& source = m_sources[i];
+
+        // Maintain each video's aspect ratio within its cell
+        float targetAspect = GetVideoAspectRatio(i);
+        if (targetAspect <= 0.0f) {
+            // No video loaded yet, default to 16:9
+            targetAspect = 16.0f / 9.0f;
+        }
+        const TileRect tile = FitAspect(cells[i], targetAspect);
+        source.rect[0] = tile.x / width * 2.0f - 1.0f;
+        source.rect[1] = tile.y / height * 2.0f - 1.0f;
+        source.rect[2] = tile.width / width * 2.0f;
+        source.rect[3] = tile.height / height * 2.0f;
+
+        // Decoding bigger than the tile is wasted work - GL_LINEAR would
+        // just shrink it again. Pick the coarsest scale that still fills it.
+        source.decodeScale = 1;
+        if (source.sourceWidth > 0 && source.sourceHeight > 0) {
+            for (int scale = 8; scale > 1; scale /= 2) {
+                if (source.sourceWidth / scale >= tile.width && source.sourceHeight / scale >= tile.height) {
+                    source.decodeScale = scale;
+                    break;
+                }
+            }
+        }
+    }
+
+    glViewport(0, 0, width, height);
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void Renderer::UploadVideoFrame(int width, int height, const std::vector<uint8_t>& rgb) {
-    if (width <= 0 || height <= 0 || rgb.empty()) {
+void Renderer::SetSourceCount(int count) {
+    m_sourceCount = std::clamp(count, 1, kMaxVideoSources);
+}
+
+void Renderer::SetSourceSize(int source, int width, int height) {
+    if (source < 0 || source >= kMaxVideoSources) {
+        return;
+    }
+    m_sources[source].sourceWidth = width;
+    m_sources[source].sourceHeight = height;
+}
+
+int Renderer::GetDecodeScale(int source) const {
+    return (source >= 0 && source < kMaxVideoSources) ? m_sources[source].decodeScale : 1;
+}
+
+FrameFormatMask Renderer::SupportedFormats() {
+    return FrameFormatBit(FrameFormat::RGB24) | FrameFormatBit(FrameFormat::NV12) |
+           FrameFormatBit(FrameFormat::NV16) | FrameFormatBit(FrameFormat::P010) |
+           FrameFormatBit(FrameFormat::Y210) | FrameFormatBit(FrameFormat::I420) |
+           FrameFormatBit(FrameFormat::I422);
+}
+
+void Renderer::UploadVideoFrame(int sourceIndex, const Frame& frame) {
+    if (frame.Empty() || sourceIndex < 0 || sourceIndex >= kMaxVideoSources) {
         return;
     }
-    
-    size_t expected_size = static_cast<size_t>(width) * static_cast<size_t>(height) * 3;
-    if (rgb.size() != expected_size) {
-        std::cerr << "Warning: RGB data size mismatch. Expected " << expected_size 
-                  << " but got " << rgb.size() << std::endl;
+    SourceState& source = m_sources[sourceIndex];
+
+    PlaneTexture textures[kMaxFramePlanes];
+    FramePlane expected[kMaxFramePlanes];
+    const int count = PlaneTextures(frame.format, textures);
+    if (count == 0 || frame.planeCount != count ||
+        FramePlaneGeometry(frame.format, frame.width, frame.height, expected) != count) {
+        std::cerr << "Warning: unexpected plane layout for " << frame.width << "x" << frame.height << " frame" << std::endl;
         return;
     }
-    
-    if (m_videoTexture == 0) {
-        InitTexture(m_videoTexture);
+    for (int p = 0; p < count; ++p) {
+        if (frame.planes[p].rowBytes != expected[p].rowBytes || frame.planes[p].rows != expected[p].rows) {
+            std::cerr << "Warning: plane " << p << " size mismatch. Expected " << expected[p].rowBytes << "x"
+                      << expected[p].rows << " bytes but got " << frame.planes[p].rowBytes << "x"
+                      << frame.planes[p].rows << std::endl;
+            return;
+        }
     }
 
-    glBindTexture(GL_TEXTURE_2D, m_videoTexture);
+    const bool realloc = frame.width != source.videoWidth || frame.height != source.videoHeight ||
+                         frame.format != source.videoFormat;
+    for (int p = 0; p < count; ++p) {
+        if (!UploadPlane(source.planeTextures[p], textures[p], frame.planes[p], realloc)) {
+            std::cerr << "Warning: plane " << p << " stride " << frame.planes[p].stride
+                      << " is not a whole number of texels" << std::endl;
+            source.videoWidth = 0; // force a full reallocation next time
+            return;
+        }
+    }
 
-    if (width != m_videoWidth || height != m_videoHeight) {
-        m_videoWidth = width;
-        m_videoHeight = height;
+    source.videoWidth = frame.width;
+    source.videoHeight = frame.height;
+    source.videoFormat = frame.format;
+    source.videoMatrix = frame.matrix;
+    source.videoFullRange = frame.fullRange;
+}
 
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RGB8,
-            width,
-            height,
-            0,
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
-            rgb.data()
-        );
-    } else {
-        glTexSubImage2D(
-            GL_TEXTURE_2D,
-            0,
-            0,
-            0,
-            width,
-            height,
-            GL_RGB,
-            GL_UNSIGNED_BYTE,
-            rgb.data()
-        );
+void Renderer::ClearSource(int sourceIndex) {
+    if (sourceIndex < 0 || sourceIndex >= kMaxVideoSources) {
+        return;
     }
+    glDeleteTextures(kMaxFramePlanes, m_sources[sourceIndex].planeTextures);
+    m_sources[sourceIndex] = SourceState{};
 }
 
 
 void Renderer::Draw() {
     m_shader->Use();
-    if (m_videoTexture != 0) {
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, m_videoTexture);
-        m_shader->SetInt("uTex", 0);
-        m_shader->SetInt("uFlipY", 1); // Flip Y for video textures
+
+    // Texture unit 3 * source + plane; uniforms are per-source arrays
+    int units[3][kMaxVideoSources];
+    int formats[kMaxVideoSources];
+    int matrices[kMaxVideoSources];
+    int fullRange[kMaxVideoSources];
+    int bitDepths[kMaxVideoSources];
+    float rects[kMaxVideoSources * 4] = {};
+    for (int i = 0; i < kMaxVideoSources; ++i) {
+        const SourceState& source = m_sources[i];
+        for (int p = 0; p < kMaxFramePlanes; ++p) {
+            units[p][i] = i * kMaxFramePlanes + p;
+        }
+        std::copy(source.rect, source.rect + 4, rects + i * 4);
+        matrices[i] = 0;
+        fullRange[i] = source.videoFullRange ? 1 : 0;
+        bitDepths[i] = FrameSampleBytes(source.videoFormat) == 2 ? 10 : 8;
+
+        // -1 = nothing uploaded yet (drawn black), 0 = RGB, 1 = Y + CbCr,
+        // 2 = packed 4:2:2, 3 = Y + Cb + Cr
+        formats[i] = -1;
+        if (i >= m_sourceCount || source.planeTextures[0] == 0 || source.videoWidth <= 0) {
+            continue;
+        }
+        PlaneTexture textures[kMaxFramePlanes];
+        const int count = PlaneTextures(source.videoFormat, textures);
+        for (int p = count - 1; p >= 0; --p) {
+            glActiveTexture(GL_TEXTURE0 + units[p][i]);
+            glBindTexture(GL_TEXTURE_2D, source.planeTextures[p]);
+        }
+        switch (source.videoFormat) {
+            case FrameFormat::RGB24: formats[i] = 0; break;
+            case FrameFormat::NV12:
+            case FrameFormat::NV16:
+            case FrameFormat::P010: formats[i] = 1; break;
+            case FrameFormat::Y210: formats[i] = 2; break;
+            case FrameFormat::I420:
+            case FrameFormat::I422: formats[i] = 3; break;
+        }
+        if (source.videoMatrix == ColorMatrix::BT709) {
+            matrices[i] = 1;
+        } else if (source.videoMatrix == ColorMatrix::BT2020) {
+            matrices[i] = 2;
+        }
     }
-    m_quad->Draw();
+    glActiveTexture(GL_TEXTURE0);
+
+    m_shader->SetIntArray("uPlane0", units[0], kMaxVideoSources);
+    m_shader->SetIntArray("uPlane1", units[1], kMaxVideoSources);
+    m_shader->SetIntArray("uPlane2", units[2], kMaxVideoSources);
+    m_shader->SetIntArray("uFormat", formats, kMaxVideoSources);
+    m_shader->SetIntArray("uMatrix", matrices, kMaxVideoSources);
+    m_shader->SetIntArray("uFullRange", fullRange, kMaxVideoSources);
+    m_shader->SetIntArray("uBitDepth", bitDepths, kMaxVideoSources);
+    m_shader->SetVec4Array("uRect", rects, kMaxVideoSources);
+    m_shader->SetInt("uFlipY", 1); // Flip Y for video textures
+
+    // The whole composite in one draw call: one quad instance per source
+    m_quad->DrawInstanced(m_sourceCount);
 }
 
-float Renderer::GetVideoAspectRatio() const {
-    if (m_videoWidth > 0 && m_videoHeight > 0) {
-        return static_cast<float>(m_videoWidth) / static_cast<float>(m_videoHeight);
+float Renderer::GetVideoAspectRatio(int source) const {
+    if (source < 0 || source >= kMaxVideoSources) {
+        return 0.0f;
+    }
+    if (m_sources[source].videoWidth > 0 && m_sources[source].videoHeight > 0) {
+        return static_cast<float>(m_sources[source].videoWidth) / static_cast<float>(m_sources[source].videoHeight);
     }
     return 0.0f;
 }
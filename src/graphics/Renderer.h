@@ -3,10 +3,19 @@
 
 #include "Shader.h"
 #include "Quad.h"
+#include "../video/Frame.h"
 #include <memory>
-#include <vector>
 namespace uvc2gl {
 
+// Most sources the compositor draws at once
+constexpr int kMaxVideoSources = 4;
+
+// How several sources share the window
+enum class CompositeLayout {
+    Grid,             // Equal tiles, row by row
+    PictureInPicture  // Source 0 fills the window, the others are insets
+};
+
 class Renderer {
 public:
     Renderer();
@@ -16,18 +25,51 @@ public:
     Renderer(const Renderer&) = delete;
     Renderer& operator=(const Renderer&) = delete;
 
+    // Lays out the tiles for a width x height window and clears it
     void PreDraw(int width, int height);
+    // Number of sources to composite (1 to kMaxVideoSources)
+    void SetSourceCount(int count);
+    int GetSourceCount() const { return m_sourceCount; }
+    void SetLayout(CompositeLayout layout) { m_layout = layout; }
+    CompositeLayout GetLayout() const { return m_layout; }
+    // Capture size of a source, for its decode scale
+    void SetSourceSize(int source, int width, int height);
+    // Largest DCT downscale (1, 2, 4 or 8) that still covers the source's tile
+    int GetDecodeScale(int source) const;
+    // Draws every source's tile with one instanced draw call
     void Draw();
     void PrintOpenGLVersion();
-    void UploadVideoFrame(int width, int height, const std::vector<uint8_t>& rgb);
-    float GetVideoAspectRatio() const;
+    // Uploads each plane of the frame to its own texture straight from the
+    // frame's storage (strides honoured, no repacking): RGB24 as RGB8,
+    // NV12/NV16 as R8 + RG8, P010 as R16 + RG16, Y210 as RG16 and I420/I422
+    // as three R8 textures. The fragment shader converts YCbCr to RGB.
+    void UploadVideoFrame(int source, const Frame& frame);
+    // Frame layouts UploadVideoFrame accepts
+    static FrameFormatMask SupportedFormats();
+    // Frees a source's textures and forgets its picture and size, so the
+    // slot draws black at the default aspect until its next upload
+    void ClearSource(int source);
+    float GetVideoAspectRatio(int source) const;
 
 private:
+    struct SourceState {
+        GLuint planeTextures[kMaxFramePlanes] = {}; // One per Frame plane; [0] is RGB or Y
+        FrameFormat videoFormat = FrameFormat::RGB24;
+        ColorMatrix videoMatrix = ColorMatrix::BT601;
+        bool videoFullRange = false;
+        int videoWidth = 0;
+        int videoHeight = 0;
+        int sourceWidth = 0;
+        int sourceHeight = 0;
+        int decodeScale = 1;
+        float rect[4] = {}; // Tile in NDC: x, y, width, height
+    };
+
     std::unique_ptr<Shader> m_shader;
     std::unique_ptr<Quad> m_quad;
-    GLuint m_videoTexture = 0;
-    int m_videoWidth = 0;
-    int m_videoHeight = 0;
+    SourceState m_sources[kMaxVideoSources];
+    int m_sourceCount = 1;
+    CompositeLayout m_layout = CompositeLayout::Grid;
 
 };
 
@@ -96,4 +96,18 @@ namespace uvc2gl {
     }
 }
 
+    void Shader::SetIntArray(const std::string& name, const int* v, int count) const {
+        GLint loc = glGetUniformLocation(m_programID, name.c_str());
+        if (loc >= 0) {
+            glUniform1iv(loc, count, v);
+        }
+    }
+
+    void Shader::SetVec4Array(const std::string& name, const float* v, int count) const {
+        GLint loc = glGetUniformLocation(m_programID, name.c_str());
+        if (loc >= 0) {
+            glUniform4fv(loc, count, v);
+        }
+    }
+
 }
\ No newline at end of file
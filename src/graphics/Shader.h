@@ -18,6 +18,8 @@ namespace uvc2gl {
             void Use() const;
             unsigned int GetID() const;
             void SetInt(const std::string& name, int v) const;
+            void SetIntArray(const std::string& name, const int* v, int count) const;
+            void SetVec4Array(const std::string& name, const float* v, int count) const;
 
         private:
             static std::string LoadShaderSource(const std::string& filepath);
@@ -0,0 +1,66 @@
+#include "AVFrameStorage.h"
+
+namespace uvc2gl {
+
+    static bool FrameFormatFromAV(int pixFmt, FrameFormat& format, bool& fullRange) {
+        switch (pixFmt) {
+            case AV_PIX_FMT_YUVJ420P:
+                fullRange = true;
+                [[fallthrough]];
+            case AV_PIX_FMT_YUV420P:
+                format = FrameFormat::I420;
+                return true;
+            case AV_PIX_FMT_YUVJ422P:
+                fullRange = true;
+                [[fallthrough]];
+            case AV_PIX_FMT_YUV422P:
+                format = FrameFormat::I422;
+                return true;
+            case AV_PIX_FMT_NV12:
+                format = FrameFormat::NV12;
+                return true;
+            case AV_PIX_FMT_P010LE:
+                format = FrameFormat::P010;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool WrapAVFrame(const AVFrame* src, Frame& out) {
+        FrameFormat format;
+        bool fullRange = (src->color_range == AVCOL_RANGE_JPEG);
+        if (!FrameFormatFromAV(src->format, format, fullRange))
+            return false;
+
+        AVFrame* ref = av_frame_clone(src);
+        if (!ref)
+            return false;
+
+        Frame frame;
+        frame.width = ref->width;
+        frame.height = ref->height;
+        frame.format = format;
+        frame.fullRange = fullRange;
+        if (ref->colorspace == AVCOL_SPC_BT709)
+            frame.matrix = ColorMatrix::BT709;
+        else if (ref->colorspace == AVCOL_SPC_BT2020_NCL)
+            frame.matrix = ColorMatrix::BT2020;
+
+        FramePlane layout[kMaxFramePlanes];
+        frame.planeCount = FramePlaneGeometry(format, frame.width, frame.height, layout);
+        for (int p = 0; p < frame.planeCount; ++p) {
+            layout[p].data = ref->data[p];
+            layout[p].stride = ref->linesize[p];
+            frame.planes[p] = layout[p];
+        }
+        frame.storage = std::shared_ptr<const void>(ref, [](const void* p) {
+            AVFrame* f = static_cast<AVFrame*>(const_cast<void*>(p));
+            av_frame_free(&f);
+        });
+
+        out = std::move(frame);
+        return true;
+    }
+
+} // namespace uvc2gl
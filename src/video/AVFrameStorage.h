@@ -0,0 +1,19 @@
+#ifndef AVFRAMESTORAGE_H
+#define AVFRAMESTORAGE_H
+
+#include "Frame.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+namespace uvc2gl {
+
+    // Describes a decoded AVFrame as a Frame without copying pixels. The Frame
+    // holds its own reference (av_frame_clone), so the decoder can move on to
+    // the next picture. Returns false if the pixel format has no FrameFormat.
+    bool WrapAVFrame(const AVFrame* src, Frame& out);
+
+} // namespace uvc2gl
+
+#endif // AVFRAMESTORAGE_H
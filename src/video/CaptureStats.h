@@ -0,0 +1,40 @@
+#ifndef CAPTURESTATS_H
+#define CAPTURESTATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace uvc2gl {
+
+// Per-subscriber FrameBus delivery counters
+struct SubscriberStats {
+    std::string name;
+    uint64_t delivered = 0;    // Frames handed to the consumer
+    uint64_t dropped = 0;      // Frames discarded by the drop policy
+    size_t queued = 0;         // Frames waiting right now
+    uint64_t framesBehind = 0; // Published frames newer than the last one delivered
+    double avgLagMs = 0.0;     // Moving average of publish -> delivery time
+};
+
+// Snapshot of capture/decode counters, safe to copy across threads
+struct CaptureStats {
+    uint64_t framesCaptured = 0;    // Buffers dequeued from V4L2 (after warmup)
+    uint64_t framesDecoded = 0;     // Frames run through the decoder
+    uint64_t framesDuplicate = 0;   // Skipped: payload identical to last decoded frame
+    uint64_t framesFailed = 0;      // Decoder rejected the payload
+    uint64_t framesSuspended = 0;   // Dropped undecoded while the window was hidden
+    uint64_t framesOverrun = 0;     // Dropped undecoded because the decoder pool was behind
+    double avgDecodeMs = 0.0;       // Moving average of decode time per frame
+    double avgCaptureLatencyMs = 0.0; // Moving average of V4L2 timestamp -> dequeue
+    int decodeScale = 1;            // Active MJPEG DCT downscale denominator
+    std::vector<SubscriberStats> subscribers; // One entry per live FrameBus subscription
+
+    // Decode time avoided by duplicate detection
+    double DecodeMsSaved() const { return static_cast<double>(framesDuplicate) * avgDecodeMs; }
+};
+
+} // namespace uvc2gl
+
+#endif // CAPTURESTATS_H
@@ -0,0 +1,15 @@
+#ifndef COLORMATRIX_H
+#define COLORMATRIX_H
+
+namespace uvc2gl {
+
+    // YCbCr -> RGB matrix of a capture format, as negotiated with the driver
+    enum class ColorMatrix {
+        BT601,
+        BT709,
+        BT2020  // Non-constant luminance
+    };
+
+} // namespace uvc2gl
+
+#endif // COLORMATRIX_H
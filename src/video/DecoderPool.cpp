@@ -0,0 +1,79 @@
+#include "DecoderPool.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace uvc2gl {
+
+    bool DecodeStrand::Post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Queue.size() >= m_MaxPending)
+                return false;
+            m_Queue.push_back(std::move(job));
+            if (m_Scheduled)
+                return true; // runs after the current job
+            m_Scheduled = true;
+        }
+        m_Jobs.Submit(JobPriority::VideoDecode, [strand = shared_from_this()] { strand->RunNext(); });
+        return true;
+    }
+
+    void DecodeStrand::Flush() {
+        std::deque<std::function<void()>> dropped;
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        dropped.swap(m_Queue);
+        m_Idle.wait(lock, [this] { return !m_Running; });
+        lock.unlock(); // dropped jobs release what they captured outside the lock
+    }
+
+    size_t DecodeStrand::Pending() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return m_Queue.size();
+    }
+
+    void DecodeStrand::RunNext() {
+        std::function<void()> job;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            if (m_Queue.empty()) {
+                m_Scheduled = false; // flushed while waiting
+                return;
+            }
+            job = std::move(m_Queue.front());
+            m_Queue.pop_front();
+            m_Running = true;
+        }
+
+        try {
+            job();
+        } catch (const std::exception& e) {
+            std::cerr << "Decode job failed: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Decode job failed" << std::endl;
+        }
+        job = nullptr; // release what the job captured before signalling
+
+        bool more;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Running = false;
+            more = !m_Queue.empty();
+            if (!more)
+                m_Scheduled = false;
+        }
+        m_Idle.notify_all();
+        // Next job of this source goes to the back, behind other sources
+        if (more)
+            m_Jobs.Submit(JobPriority::VideoDecode, [strand = shared_from_this()] { strand->RunNext(); });
+    }
+
+    DecoderPool::DecoderPool(std::shared_ptr<JobSystem> jobs) : m_Jobs(std::move(jobs)) {
+    }
+
+    std::shared_ptr<DecodeStrand> DecoderPool::CreateStrand(size_t maxPending) {
+        // Constructor is private to keep strands tied to a pool
+        return std::shared_ptr<DecodeStrand>(new DecodeStrand(*m_Jobs, std::max<size_t>(maxPending, 1)));
+    }
+
+} // namespace uvc2gl
@@ -0,0 +1,71 @@
+#ifndef DECODERPOOL_H
+#define DECODERPOOL_H
+
+#include "../core/JobSystem.h"
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace uvc2gl {
+
+    class DecoderPool;
+
+    // A per-source job queue on a DecoderPool. Jobs posted to one strand run
+    // one at a time in order (decoders keep state between frames), while
+    // different strands run in parallel on the job system's workers.
+    class DecodeStrand : public std::enable_shared_from_this<DecodeStrand> {
+        public:
+            DecodeStrand(const DecodeStrand&) = delete;
+            DecodeStrand& operator=(const DecodeStrand&) = delete;
+
+            // Returns false (and drops the job) when maxPending jobs are
+            // already waiting - the caller should skip the frame
+            bool Post(std::function<void()> job);
+
+            // Drops jobs that haven't started and waits for a running one
+            void Flush();
+
+            size_t Pending() const;
+
+        private:
+            friend class DecoderPool;
+            DecodeStrand(JobSystem& jobs, size_t maxPending) : m_Jobs(jobs), m_MaxPending(maxPending) {}
+
+            // Runs the next job, then hands the strand back to the job
+            // system if more are waiting
+            void RunNext();
+
+            JobSystem& m_Jobs;
+            const size_t m_MaxPending;
+            mutable std::mutex m_Mutex;
+            std::condition_variable m_Idle;
+            std::deque<std::function<void()>> m_Queue;
+            bool m_Scheduled = false;
+            bool m_Running = false;
+    };
+
+    // Decode front end shared by every VideoCapture: strands run as
+    // VideoDecode jobs on the process-wide JobSystem, so several sources
+    // share the cores instead of each needing a decode thread of their own.
+    // Strands must not outlive the job system.
+    class DecoderPool {
+        public:
+            explicit DecoderPool(std::shared_ptr<JobSystem> jobs);
+
+            DecoderPool(const DecoderPool&) = delete;
+            DecoderPool& operator=(const DecoderPool&) = delete;
+
+            std::shared_ptr<DecodeStrand> CreateStrand(size_t maxPending = 2);
+            size_t ThreadCount() const { return m_Jobs->WorkerCount(); }
+            JobSystem& Jobs() const { return *m_Jobs; }
+
+        private:
+            std::shared_ptr<JobSystem> m_Jobs;
+    };
+
+} // namespace uvc2gl
+
+#endif // DECODERPOOL_H
@@ -0,0 +1,55 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace uvc2gl {
+
+    // Fast 64-bit fingerprint of a compressed payload.
+    // Not cryptographic - only used to spot byte-identical frames (static
+    // source / no signal) before they reach the decoder.
+    // Four independent lanes of 8-byte words keep the multiplies pipelined,
+    // so a 1080p MJPEG payload hashes in a few microseconds.
+    inline uint64_t PayloadFingerprint(const uint8_t* data, size_t size) {
+        constexpr uint64_t kMul = 0x9E3779B97F4A7C15ull;
+        uint64_t h0 = size ^ kMul;
+        uint64_t h1 = size + kMul;
+        uint64_t h2 = ~size;
+        uint64_t h3 = size * kMul;
+
+        auto mix = [](uint64_t h, uint64_t w) {
+            h = (h ^ w) * kMul;
+            return h ^ (h >> 29);
+        };
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32) {
+            uint64_t w[4];
+            std::memcpy(w, data + i, sizeof(w));
+            h0 = mix(h0, w[0]);
+            h1 = mix(h1, w[1]);
+            h2 = mix(h2, w[2]);
+            h3 = mix(h3, w[3]);
+        }
+        for (; i + 8 <= size; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, data + i, sizeof(w));
+            h0 = mix(h0, w);
+        }
+        uint64_t tail = 0;
+        for (size_t shift = 0; i < size; ++i, shift += 8) {
+            tail |= static_cast<uint64_t>(data[i]) << shift;
+        }
+        h1 = mix(h1, tail);
+
+        uint64_t h = mix(h0, h1);
+        h = mix(h, h2);
+        h = mix(h, h3);
+        return h;
+    }
+
+} // namespace uvc2gl
+
+#endif // FINGERPRINT_H
@@ -1,16 +1,126 @@
 #ifndef FRAME_H
 #define FRAME_H
 
+#include "ColorMatrix.h"
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <vector>
+#include <memory>
 namespace uvc2gl{
+
+// Pixel layout of a Frame's planes
+enum class FrameFormat {
+    RGB24,  // Packed 8-bit RGB
+    NV12,   // Y plane, then interleaved CbCr at half width and half height
+    NV16,   // Y plane, then interleaved CbCr at half width and full height
+    P010,   // NV12 layout with 16-bit samples, 10 bits in the high bits
+    Y210,   // Packed Y0 Cb Y1 Cr with 16-bit samples, 10 bits in the high bits
+    I420,   // Y, Cb and Cr planes, chroma at half width and half height
+    I422    // Y, Cb and Cr planes, chroma at half width and full height
+};
+
+// Set of FrameFormats, one bit per format
+using FrameFormatMask = uint32_t;
+
+constexpr FrameFormatMask FrameFormatBit(FrameFormat format) {
+    return 1u << static_cast<unsigned>(format);
+}
+
+// Bytes per sample of a YCbCr layout (little endian when 2)
+inline int FrameSampleBytes(FrameFormat format) {
+    return (format == FrameFormat::P010 || format == FrameFormat::Y210) ? 2 : 1;
+}
+
+// Rows in the chroma plane(s) of the planar and semi-planar layouts
+inline int FrameChromaRows(FrameFormat format, int height) {
+    return (format == FrameFormat::NV12 || format == FrameFormat::P010 || format == FrameFormat::I420)
+           ? (height + 1) / 2 : height;
+}
+
+constexpr int kMaxFramePlanes = 3;
+
+struct FramePlane {
+    const uint8_t* data = nullptr;
+    int stride = 0;    // Bytes from one row to the next
+    int rowBytes = 0;  // Bytes of pixel data in a row
+    int rows = 0;
+
+    size_t Size() const { return rows > 0 ? static_cast<size_t>(stride) * (rows - 1) + rowBytes : 0; }
+};
+
+// Row size and row count of every plane of a format; returns the plane count
+inline int FramePlaneGeometry(FrameFormat format, int width, int height, FramePlane (&planes)[kMaxFramePlanes]) {
+    const int sampleBytes = FrameSampleBytes(format);
+    const int chromaWidth = (width + 1) / 2;
+    const int chromaRows = FrameChromaRows(format, height);
+    for (auto& plane : planes)
+        plane = FramePlane{};
+    switch (format) {
+        case FrameFormat::RGB24:
+            planes[0].rowBytes = width * 3;
+            planes[0].rows = height;
+            return 1;
+        case FrameFormat::Y210:
+            planes[0].rowBytes = chromaWidth * 4 * sampleBytes;
+            planes[0].rows = height;
+            return 1;
+        case FrameFormat::NV12:
+        case FrameFormat::NV16:
+        case FrameFormat::P010:
+            planes[0].rowBytes = width * sampleBytes;
+            planes[0].rows = height;
+            planes[1].rowBytes = chromaWidth * 2 * sampleBytes;
+            planes[1].rows = chromaRows;
+            return 2;
+        case FrameFormat::I420:
+        case FrameFormat::I422:
+            planes[0].rowBytes = width;
+            planes[0].rows = height;
+            planes[1].rowBytes = planes[2].rowBytes = chromaWidth;
+            planes[1].rows = planes[2].rows = chromaRows;
+            return 3;
+    }
+    return 0;
+}
+
+// A decoded or captured picture. The planes point into memory owned by
+// storage - a pooled buffer, an AVFrame reference or a V4L2 buffer lease -
+// which is released (and the buffer recycled or re-queued) when the last
+// copy of the Frame goes away. Copying a Frame never copies pixels.
 struct Frame {
-    int width;
-    int height;
-    std::vector<uint8_t> data;
-    uint64_t timestamp; // in nanoseconds
+    int width = 0;
+    int height = 0;
+    FrameFormat format = FrameFormat::RGB24;
+    ColorMatrix matrix = ColorMatrix::BT601; // YCbCr formats only
+    bool fullRange = false;                  // YCbCr formats only
+    int planeCount = 0;
+    std::array<FramePlane, kMaxFramePlanes> planes{};
+    std::shared_ptr<const void> storage;
+    uint64_t timestamp = 0; // in nanoseconds
+    bool deviceBuffer = false; // storage is a capture buffer the driver needs back; copy to hold on to it
+
+    bool Empty() const { return planeCount == 0 || width <= 0 || height <= 0 || !planes[0].data; }
+
+    // Points the planes at one buffer holding them back to back without
+    // row padding. Returns false if size is too small for the format.
+    bool SetContiguousPlanes(const uint8_t* base, size_t size) {
+        FramePlane layout[kMaxFramePlanes];
+        int count = FramePlaneGeometry(format, width, height, layout);
+        size_t offset = 0;
+        for (int p = 0; p < count; ++p) {
+            layout[p].data = base + offset;
+            layout[p].stride = layout[p].rowBytes;
+            offset += layout[p].Size();
+        }
+        if (count == 0 || offset > size)
+            return false;
+        planeCount = count;
+        for (int p = 0; p < count; ++p)
+            planes[p] = layout[p];
+        return true;
+    }
 
 };
 }
 
-#endif // FRAME_H
\ No newline at end of file
+#endif // FRAME_H
@@ -0,0 +1,111 @@
+#include "FrameBus.h"
+#include <algorithm>
+
+namespace uvc2gl {
+
+    FrameSubscription::FrameSubscription(std::string name, FrameDropPolicy policy, size_t depth)
+        : m_Name(std::move(name)),
+          m_Depth(policy == FrameDropPolicy::LatestOnly ? 1 : std::max<size_t>(depth, 1)) {}
+
+    void FrameSubscription::Deliver(const Frame& frame, uint64_t sequence, std::chrono::steady_clock::time_point published) {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            while (m_Queue.size() >= m_Depth) {
+                m_Queue.pop_front();
+                m_Dropped++;
+            }
+            m_Queue.push_back({ frame, sequence, published });
+            m_LastPublished = sequence;
+        }
+        m_Ready.notify_one();
+    }
+
+    std::optional<Frame> FrameSubscription::TakeLocked() {
+        if (m_Queue.empty())
+            return std::nullopt;
+        Entry entry = std::move(m_Queue.front());
+        m_Queue.pop_front();
+
+        double lagMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - entry.published).count();
+        m_AvgLagMs = m_Delivered == 0 ? lagMs : m_AvgLagMs * 0.95 + lagMs * 0.05;
+        m_Delivered++;
+        m_LastDelivered = entry.sequence;
+        return std::move(entry.frame);
+    }
+
+    std::optional<Frame> FrameSubscription::Pop() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        return TakeLocked();
+    }
+
+    std::optional<Frame> FrameSubscription::WaitPop(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Ready.wait_for(lock, timeout, [this] { return !m_Queue.empty(); });
+        return TakeLocked();
+    }
+
+    void FrameSubscription::Clear() {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Queue.clear();
+    }
+
+    SubscriberStats FrameSubscription::GetStats() const {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        SubscriberStats stats;
+        stats.name = m_Name;
+        stats.delivered = m_Delivered;
+        stats.dropped = m_Dropped;
+        stats.queued = m_Queue.size();
+        stats.framesBehind = m_LastPublished > m_LastDelivered ? m_LastPublished - m_LastDelivered : 0;
+        stats.avgLagMs = m_AvgLagMs;
+        return stats;
+    }
+
+    std::shared_ptr<FrameSubscription> FrameBus::Subscribe(const std::string& name, FrameDropPolicy policy, size_t depth) {
+        auto subscription = std::make_shared<FrameSubscription>(name, policy, depth);
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Subscriptions.push_back(subscription);
+        return subscription;
+    }
+
+    std::vector<std::shared_ptr<FrameSubscription>> FrameBus::LiveSubscriptions() const {
+        std::vector<std::shared_ptr<FrameSubscription>> live;
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        // Forget subscribers that have gone away
+        m_Subscriptions.erase(std::remove_if(m_Subscriptions.begin(), m_Subscriptions.end(),
+                                             [](const auto& weak) { return weak.expired(); }),
+                              m_Subscriptions.end());
+        live.reserve(m_Subscriptions.size());
+        for (const auto& weak : m_Subscriptions) {
+            if (auto subscription = weak.lock())
+                live.push_back(std::move(subscription));
+        }
+        return live;
+    }
+
+    void FrameBus::Publish(const Frame& frame) {
+        uint64_t sequence;
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            sequence = ++m_Sequence;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        // Each subscriber gets a copy of the descriptor; the pixels stay shared
+        for (const auto& subscription : LiveSubscriptions())
+            subscription->Deliver(frame, sequence, now);
+    }
+
+    void FrameBus::Clear() {
+        for (const auto& subscription : LiveSubscriptions())
+            subscription->Clear();
+    }
+
+    std::vector<SubscriberStats> FrameBus::GetStats() const {
+        std::vector<SubscriberStats> stats;
+        for (const auto& subscription : LiveSubscriptions())
+            stats.push_back(subscription->GetStats());
+        return stats;
+    }
+
+} // namespace uvc2gl
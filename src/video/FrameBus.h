@@ -0,0 +1,104 @@
+#ifndef FRAMEBUS_H
+#define FRAMEBUS_H
+
+#include "CaptureStats.h"
+#include "Frame.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace uvc2gl {
+
+    // What a subscription does when a frame arrives and its queue is full
+    enum class FrameDropPolicy {
+        LatestOnly,  // Keep only the newest frame (display)
+        BoundedFifo  // Keep up to depth frames in order, dropping the oldest (recording)
+    };
+
+    class FrameBus;
+
+    // One consumer's view of the bus. Frames share their storage with every
+    // other subscriber, so queueing one never copies pixels - but a queued
+    // frame keeps its buffer (pooled, AVFrame or V4L2 lease) alive.
+    class FrameSubscription {
+        public:
+            FrameSubscription(std::string name, FrameDropPolicy policy, size_t depth);
+
+            FrameSubscription(const FrameSubscription&) = delete;
+            FrameSubscription& operator=(const FrameSubscription&) = delete;
+
+            // Oldest queued frame (the only one with LatestOnly), if any
+            std::optional<Frame> Pop();
+            // Like Pop, but waits up to timeout for a frame to be published
+            std::optional<Frame> WaitPop(std::chrono::milliseconds timeout);
+
+            void Clear();
+            SubscriberStats GetStats() const;
+            const std::string& Name() const { return m_Name; }
+
+        private:
+            friend class FrameBus;
+
+            struct Entry {
+                Frame frame;
+                uint64_t sequence;
+                std::chrono::steady_clock::time_point published;
+            };
+
+            void Deliver(const Frame& frame, uint64_t sequence, std::chrono::steady_clock::time_point published);
+            std::optional<Frame> TakeLocked();
+
+            const std::string m_Name;
+            // Always 1 for LatestOnly, which is all the policy changes
+            const size_t m_Depth;
+
+            mutable std::mutex m_Mutex;
+            std::condition_variable m_Ready;
+            std::deque<Entry> m_Queue;
+            uint64_t m_Delivered = 0;
+            uint64_t m_Dropped = 0;
+            uint64_t m_LastPublished = 0;
+            uint64_t m_LastDelivered = 0;
+            double m_AvgLagMs = 0.0;
+    };
+
+    // Fans each published frame out to every live subscription. The bus
+    // only holds weak references: dropping the shared_ptr returned by
+    // Subscribe() unsubscribes.
+    class FrameBus {
+        public:
+            FrameBus() = default;
+
+            FrameBus(const FrameBus&) = delete;
+            FrameBus& operator=(const FrameBus&) = delete;
+
+            // depth is ignored for LatestOnly
+            std::shared_ptr<FrameSubscription> Subscribe(const std::string& name,
+                                                         FrameDropPolicy policy = FrameDropPolicy::LatestOnly,
+                                                         size_t depth = 1);
+
+            void Publish(const Frame& frame);
+
+            // Drops every queued frame, releasing their storage
+            void Clear();
+
+            std::vector<SubscriberStats> GetStats() const;
+
+        private:
+            std::vector<std::shared_ptr<FrameSubscription>> LiveSubscriptions() const;
+
+            mutable std::mutex m_Mutex;
+            mutable std::vector<std::weak_ptr<FrameSubscription>> m_Subscriptions;
+            uint64_t m_Sequence = 0;
+    };
+
+} // namespace uvc2gl
+
+#endif // FRAMEBUS_H
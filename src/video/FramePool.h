@@ -0,0 +1,100 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include "Frame.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace uvc2gl {
+
+    // Recycles the byte buffers behind CPU-produced Frames. Acquire() hands
+    // out a buffer whose shared_ptr returns it to the pool when the last Frame
+    // using it is dropped, so steady-state capture does not allocate. Buffers
+    // released after the pool is gone are simply freed.
+    class FramePool {
+        public:
+            explicit FramePool(size_t maxFree = 8)
+                : m_State(std::make_shared<State>()) {
+                m_State->maxFree = maxFree;
+            }
+
+            FramePool(const FramePool&) = delete;
+            FramePool& operator=(const FramePool&) = delete;
+
+            // Contents are unspecified; resize before use (capacity is kept)
+            std::shared_ptr<std::vector<uint8_t>> Acquire() {
+                std::unique_ptr<std::vector<uint8_t>> buffer;
+                {
+                    std::lock_guard<std::mutex> lock(m_State->mutex);
+                    if (!m_State->free.empty()) {
+                        buffer = std::move(m_State->free.back());
+                        m_State->free.pop_back();
+                    }
+                }
+                if (!buffer)
+                    buffer = std::make_unique<std::vector<uint8_t>>();
+
+                std::weak_ptr<State> weakState = m_State;
+                return std::shared_ptr<std::vector<uint8_t>>(buffer.release(), [weakState](std::vector<uint8_t>* released) {
+                    std::unique_ptr<std::vector<uint8_t>> owned(released);
+                    if (auto state = weakState.lock()) {
+                        std::lock_guard<std::mutex> lock(state->mutex);
+                        if (state->free.size() < state->maxFree)
+                            state->free.push_back(std::move(owned));
+                    }
+                });
+            }
+
+            // Wraps an already filled pooled buffer as a tightly packed Frame
+            static bool WrapBuffer(std::shared_ptr<std::vector<uint8_t>> buffer, FrameFormat format, int width, int height, Frame& frame) {
+                frame.format = format;
+                frame.width = width;
+                frame.height = height;
+                if (!frame.SetContiguousPlanes(buffer->data(), buffer->size()))
+                    return false;
+                frame.storage = std::move(buffer);
+                return true;
+            }
+
+            // Deep copy into a pooled buffer, dropping row padding. Used when
+            // the source storage (e.g. a V4L2 buffer) can't be held any longer.
+            Frame Copy(const Frame& src) {
+                FramePlane layout[kMaxFramePlanes];
+                int count = FramePlaneGeometry(src.format, src.width, src.height, layout);
+                size_t size = 0;
+                for (int p = 0; p < count; ++p)
+                    size += static_cast<size_t>(layout[p].rowBytes) * layout[p].rows;
+
+                auto buffer = Acquire();
+                buffer->resize(size);
+                uint8_t* dst = buffer->data();
+                for (int p = 0; p < count && p < src.planeCount; ++p) {
+                    const FramePlane& from = src.planes[p];
+                    for (int row = 0; row < layout[p].rows; ++row, dst += layout[p].rowBytes)
+                        std::copy_n(from.data + static_cast<size_t>(from.stride) * row, layout[p].rowBytes, dst);
+                }
+
+                Frame frame;
+                WrapBuffer(std::move(buffer), src.format, src.width, src.height, frame);
+                frame.matrix = src.matrix;
+                frame.fullRange = src.fullRange;
+                frame.timestamp = src.timestamp;
+                return frame;
+            }
+
+        private:
+            struct State {
+                std::mutex mutex;
+                std::vector<std::unique_ptr<std::vector<uint8_t>>> free;
+                size_t maxFree = 8;
+            };
+            std::shared_ptr<State> m_State;
+    };
+
+} // namespace uvc2gl
+
+#endif // FRAMEPOOL_H
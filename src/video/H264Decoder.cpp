@@ -0,0 +1,160 @@
+#include "H264Decoder.h"
+#include "AVFrameStorage.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace uvc2gl {
+
+    static int64_t SteadyNowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    H264Decoder::H264Decoder(bool lowDelay) {
+        const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+        if (!codec)
+            throw std::runtime_error("H.264 decoder not found");
+        m_codecCtx = avcodec_alloc_context3(codec);
+        if (!m_codecCtx)
+            throw std::runtime_error("Failed to allocate codec context");
+
+        // Let libavcodec pick one thread per core. AV_CODEC_FLAG_LOW_DELAY
+        // makes it fall back from frame to slice threading on its own.
+        m_codecCtx->thread_count = 0;
+        m_codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        m_codecCtx->flags2 |= AV_CODEC_FLAG2_FAST;
+        if (lowDelay)
+            m_codecCtx->flags |= AV_CODEC_FLAG_LOW_DELAY;
+
+        if (avcodec_open2(m_codecCtx, codec, nullptr) < 0) {
+            avcodec_free_context(&m_codecCtx);
+            throw std::runtime_error("Failed to open H.264 codec");
+        }
+
+        m_frame = av_frame_alloc();
+        m_packet = av_packet_alloc();
+        if (!m_frame || !m_packet)
+            throw std::runtime_error("Failed to allocate frame or packet");
+    }
+
+    H264Decoder::~H264Decoder() {
+        if (m_swsCtx)
+            sws_freeContext(m_swsCtx);
+        if (m_frame)
+            av_frame_free(&m_frame);
+        if (m_packet)
+            av_packet_free(&m_packet);
+        if (m_codecCtx)
+            avcodec_free_context(&m_codecCtx);
+    }
+
+    void H264Decoder::ResetSwsContext(int width, int height, AVPixelFormat pixFmt) {
+        if (m_swsCtx) {
+            sws_freeContext(m_swsCtx);
+            m_swsCtx = nullptr;
+        }
+
+        m_swsCtx = sws_getContext(
+            width, height, pixFmt,
+            width, height, AV_PIX_FMT_RGB24,
+            SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!m_swsCtx)
+            throw std::runtime_error("Failed to create SwsContext");
+        m_width = width;
+        m_height = height;
+        m_pixFmt = pixFmt;
+    }
+
+    void H264Decoder::Flush() {
+        avcodec_flush_buffers(m_codecCtx);
+        m_inFlight.clear();
+        m_waitForIdr = true;
+    }
+
+    bool H264Decoder::HasIdrSlice(const uint8_t* data, size_t size) {
+        // NAL units follow 00 00 01 start codes (the 4-byte form ends the same way)
+        for (size_t i = 0; i + 3 < size; ++i) {
+            if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1) {
+                if ((data[i + 3] & 0x1F) == 5)
+                    return true;
+                i += 2;
+            }
+        }
+        return false;
+    }
+
+    DecodeStatus H264Decoder::Decode(const uint8_t* data, size_t size, int64_t captureTimeNs, Frame& out, DecodedPicture& picture) {
+        if (size == 0)
+            return DecodeStatus::Error;
+        if (m_waitForIdr) {
+            if (!HasIdrSlice(data, size))
+                return DecodeStatus::NeedMore;
+            m_waitForIdr = false;
+        }
+
+        // Copy: with frame threading the decoder keeps packets past the
+        // V4L2 requeue, so the mmap buffer can't be borrowed here
+        av_packet_unref(m_packet);
+        if (av_new_packet(m_packet, static_cast<int>(size)) < 0)
+            return DecodeStatus::Error;
+        std::memcpy(m_packet->data, data, size);
+
+        // pts carries the capture timestamp through the decoder's reordering;
+        // it must be strictly increasing even if the driver's clock isn't
+        int64_t pts = captureTimeNs > m_lastPts ? captureTimeNs : m_lastPts + 1;
+        m_lastPts = pts;
+        m_packet->pts = pts;
+        m_packet->dts = pts;
+        m_inFlight.push_back({ pts, SteadyNowNs() });
+        while (m_inFlight.size() > 64)
+            m_inFlight.pop_front(); // decoder dropped frames we never saw
+
+        int ret = avcodec_send_packet(m_codecCtx, m_packet);
+        av_packet_unref(m_packet);
+        if (ret < 0)
+            return DecodeStatus::Error;
+
+        bool gotPicture = false;
+        while ((ret = avcodec_receive_frame(m_codecCtx, m_frame)) == 0) {
+            int width = m_frame->width;
+            int height = m_frame->height;
+            // Native output references the decoder's picture (usually I420);
+            // otherwise, or for formats Frame can't describe, convert to RGB24
+            if (!m_nativeOutput || !WrapAVFrame(m_frame, out)) {
+                if (!m_swsCtx || width != m_width || height != m_height || m_frame->format != m_pixFmt) {
+                    ResetSwsContext(width, height, static_cast<AVPixelFormat>(m_frame->format));
+                }
+
+                auto buffer = m_framePool.Acquire();
+                buffer->resize((size_t)width * (size_t)height * 3);
+                uint8_t* destData[4] = { buffer->data(), nullptr, nullptr, nullptr };
+                int destLinesize[4] = { width * 3, 0, 0, 0 };
+                sws_scale(m_swsCtx,
+                          m_frame->data, m_frame->linesize,
+                          0, height,
+                          destData, destLinesize);
+                FramePool::WrapBuffer(std::move(buffer), FrameFormat::RGB24, width, height, out);
+            }
+
+            picture.width = width;
+            picture.height = height;
+            picture.captureTimeNs = m_frame->pts;
+            picture.decodeLatencyMs = 0.0;
+            for (auto it = m_inFlight.begin(); it != m_inFlight.end(); ++it) {
+                if (it->pts == m_frame->pts) {
+                    picture.decodeLatencyMs = (SteadyNowNs() - it->submitTimeNs) / 1e6;
+                    m_inFlight.erase(it);
+                    break;
+                }
+            }
+            av_frame_unref(m_frame);
+            gotPicture = true;
+        }
+        if (gotPicture)
+            return DecodeStatus::Picture;
+        // EAGAIN just means the decoder wants more input
+        return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? DecodeStatus::NeedMore : DecodeStatus::Error;
+    }
+
+} // namespace uvc2gl
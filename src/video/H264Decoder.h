@@ -0,0 +1,82 @@
+#ifndef H264DECODER_H
+#define H264DECODER_H
+
+#include "FramePool.h"
+#include <cstdint>
+#include <deque>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libswscale/swscale.h>
+}
+
+namespace uvc2gl {
+
+    // What one access unit produced
+    enum class DecodeStatus {
+        Picture,   // A picture came out (possibly for an earlier access unit)
+        NeedMore,  // Accepted, but the decoder is still filling its pipeline
+        Error      // The packet was rejected or decoding failed
+    };
+
+    struct DecodedPicture {
+        int width = 0;
+        int height = 0;
+        int64_t captureTimeNs = 0;     // V4L2 timestamp of the access unit this picture came from
+        double decodeLatencyMs = 0.0;  // Packet submission -> picture out, including threading delay
+    };
+
+    // FFmpeg H.264 decoder for UVC H.264 streams.
+    // lowDelay uses slice threading only and outputs every picture as soon as
+    // it is decoded; without it frame threading adds one frame of latency
+    // per thread in exchange for throughput.
+    class H264Decoder {
+        public:
+            explicit H264Decoder(bool lowDelay = true);
+            ~H264Decoder();
+
+            H264Decoder(const H264Decoder&) = delete;
+            H264Decoder& operator=(const H264Decoder&) = delete;
+
+            // Submits one access unit. The decoder may hold frames back, so
+            // NeedMore is not an error.
+            DecodeStatus Decode(const uint8_t* data, size_t size, int64_t captureTimeNs, Frame& out, DecodedPicture& picture);
+
+            // Drops the decoder's references and pictures in flight, then skips
+            // access units (returning NeedMore) until the next IDR. For when
+            // the caller has thrown access units away: decoding on without
+            // them would corrupt every frame up to the next IDR anyway.
+            void Flush();
+
+            // Hand out the decoder's own planar pictures instead of RGB24
+            void SetNativeOutput(bool enabled) { m_nativeOutput = enabled; }
+
+        private:
+            struct InFlight {
+                int64_t pts;
+                int64_t submitTimeNs;
+            };
+
+            void ResetSwsContext(int width, int height, AVPixelFormat pixFmt);
+            // True if the Annex B access unit holds an IDR slice
+            static bool HasIdrSlice(const uint8_t* data, size_t size);
+
+            AVCodecContext* m_codecCtx = nullptr;
+            AVFrame* m_frame = nullptr;
+            AVPacket* m_packet = nullptr;
+            SwsContext* m_swsCtx = nullptr;
+            int m_width = 0;
+            int m_height = 0;
+            AVPixelFormat m_pixFmt = AV_PIX_FMT_NONE;
+
+            bool m_nativeOutput = false;
+            FramePool m_framePool;
+
+            std::deque<InFlight> m_inFlight;
+            int64_t m_lastPts = 0;
+            bool m_waitForIdr = false;
+    };
+
+} // namespace uvc2gl
+
+#endif // H264DECODER_H
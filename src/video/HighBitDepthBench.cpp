@@ -0,0 +1,124 @@
+// Compares the capture-thread cost of the 10-bit paths on a synthetic P010 frame:
+//   p010        - 16-bit planes copied as-is, converted in the shader (what VideoCapture does)
+//   p010->nv12  - truncated to 8-bit NV12 on the CPU, shader conversion
+//   p010->rgb24 - truncated and converted to RGB24 on the CPU
+//   HighBitDepthBench [width] [height] [frames] [fps]
+#include "PixelKernels.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace uvc2gl;
+
+// Each path turns the P010 buffer into what gets uploaded to the GPU
+using PathFn = std::function<void(const std::vector<uint8_t>& src, int width, int height, std::vector<uint8_t>& out)>;
+
+static void CopyP010(const std::vector<uint8_t>& src, int, int, std::vector<uint8_t>& out) {
+    out.resize(src.size());
+    std::memcpy(out.data(), src.data(), src.size());
+}
+
+static void P010ToNv12(const std::vector<uint8_t>& src, int width, int height, std::vector<uint8_t>& out) {
+    const size_t samples = static_cast<size_t>(width) * height + static_cast<size_t>(width) * ((height + 1) / 2);
+    out.resize(samples);
+    const uint16_t* in = reinterpret_cast<const uint16_t*>(src.data());
+    for (size_t i = 0; i < samples; ++i) {
+        out[i] = static_cast<uint8_t>(in[i] >> 8);
+    }
+}
+
+static void P010ToRgb24(const std::vector<uint8_t>& src, int width, int height, std::vector<uint8_t>& out) {
+    const uint16_t* luma = reinterpret_cast<const uint16_t*>(src.data());
+    const uint16_t* chroma = luma + static_cast<size_t>(width) * height;
+    out.resize(static_cast<size_t>(width) * height * 3);
+    uint8_t* dst = out.data();
+    for (int row = 0; row < height; ++row) {
+        const uint16_t* y = luma + static_cast<size_t>(row) * width;
+        const uint16_t* c = chroma + static_cast<size_t>(row / 2) * width;
+        for (int x = 0; x < width; ++x) {
+            const int cb = c[x & ~1] >> 8;
+            const int cr = c[(x & ~1) + 1] >> 8;
+            YuvToRgb<ColorMatrix::BT2020>(y[x] >> 8, cb - 128, cr - 128, dst);
+            dst += 3;
+        }
+    }
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+int main(int argc, char* argv[]) {
+    const int width = (argc >= 2) ? std::max(2, std::atoi(argv[1])) & ~1 : 3840;
+    const int height = (argc >= 3) ? std::max(2, std::atoi(argv[2])) & ~1 : 2160;
+    const int frames = (argc >= 4) ? std::max(1, std::atoi(argv[3])) : 200;
+    const int fps = (argc >= 5) ? std::max(1, std::atoi(argv[4])) : 60;
+
+    // Limited-range ramp with 10 bits in the high bits, like a real P010 buffer
+    const size_t samples = static_cast<size_t>(width) * height * 3 / 2;
+    std::vector<uint8_t> p010(samples * 2);
+    uint16_t* s = reinterpret_cast<uint16_t*>(p010.data());
+    for (size_t i = 0; i < samples; ++i) {
+        s[i] = static_cast<uint16_t>((64 + (i * 7) % 877) << 6);
+    }
+
+    struct Path {
+        const char* name;
+        PathFn fn;
+    };
+    const Path paths[] = {
+        { "p010", CopyP010 },
+        { "p010->nv12", P010ToNv12 },
+        { "p010->rgb24", P010ToRgb24 },
+    };
+
+    std::cout << width << "x" << height << ", " << frames << " frames, upload rate at " << fps << " fps" << std::endl;
+    std::cout << std::left << std::setw(14) << "path"
+              << std::right << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << std::setw(12) << "CPU GB/s"
+              << std::setw(12) << "upload MB" << std::setw(12) << "upload GB/s" << std::endl;
+
+    for (const auto& path : paths) {
+        std::vector<uint8_t> out;
+        path.fn(p010, width, height, out); // warm up: allocate the output
+
+        std::vector<double> latencies;
+        latencies.reserve(frames);
+        for (int i = 0; i < frames; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            path.fn(p010, width, height, out);
+            auto end = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0.0;
+        for (double l : latencies) {
+            total += l;
+        }
+        double mean = total / latencies.size();
+
+        // Bytes read plus bytes written per frame, and what glTexSubImage2D moves
+        double cpuBytes = static_cast<double>(p010.size() + out.size());
+        double uploadMB = static_cast<double>(out.size()) / (1024.0 * 1024.0);
+        std::cout << std::left << std::setw(14) << path.name
+                  << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(10) << mean
+                  << std::setw(10) << Percentile(latencies, 0.50)
+                  << std::setw(10) << Percentile(latencies, 0.99)
+                  << std::setprecision(2)
+                  << std::setw(12) << cpuBytes / (mean * 1e6)
+                  << std::setw(12) << uploadMB
+                  << std::setw(12) << static_cast<double>(out.size()) * fps / 1e9 << std::endl;
+    }
+
+    return 0;
+}
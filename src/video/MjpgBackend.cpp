@@ -0,0 +1,40 @@
+#include "MjpgBackend.h"
+#include "MjpgDecoder.h"
+#ifdef UVC2GL_HAVE_TURBOJPEG
+#include "TurboJpegDecoder.h"
+#endif
+
+#include <stdexcept>
+
+namespace uvc2gl {
+
+    std::unique_ptr<MjpgBackend> MjpgBackend::Create(const std::string& name) {
+        if (name == "ffmpeg") {
+            return std::make_unique<MjpgDecoder>();
+        }
+#ifdef UVC2GL_HAVE_TURBOJPEG
+        if (name == "turbojpeg") {
+            return std::make_unique<TurboJpegDecoder>();
+        }
+#endif
+        throw std::runtime_error("Unknown MJPEG backend: " + name);
+    }
+
+    bool MjpgBackend::DecodeToFrame(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength, Frame& out) {
+        auto buffer = m_framePool.Acquire();
+        int width = 0;
+        int height = 0;
+        if (!DecodeToRGB(mjpgData, mjpgSize, bufferLength, width, height, *buffer))
+            return false;
+        return FramePool::WrapBuffer(std::move(buffer), FrameFormat::RGB24, width, height, out);
+    }
+
+    std::vector<std::string> MjpgBackend::Available() {
+        std::vector<std::string> names = { "ffmpeg" };
+#ifdef UVC2GL_HAVE_TURBOJPEG
+        names.push_back("turbojpeg");
+#endif
+        return names;
+    }
+
+} // namespace uvc2gl
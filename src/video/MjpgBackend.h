@@ -0,0 +1,51 @@
+#ifndef MJPGBACKEND_H
+#define MJPGBACKEND_H
+
+#include "FramePool.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace uvc2gl {
+
+    // Interface for MJPEG -> RGB24 decoders, selectable at runtime by name
+    class MjpgBackend {
+        public:
+            virtual ~MjpgBackend() = default;
+
+            virtual const char* Name() const = 0;
+
+            virtual bool DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out) = 0;
+
+            // Decode from a writable caller-owned buffer (e.g. a V4L2 mmap buffer).
+            // Backends that can borrow the memory override this; ReleaseInput()
+            // must be called before the buffer is reused.
+            virtual bool DecodeToRGB(uint8_t* mjpgData, size_t mjpgSize, size_t /*bufferLength*/, int& width, int& height, std::vector<uint8_t>& out) {
+                return DecodeToRGB(static_cast<const unsigned char*>(mjpgData), mjpgSize, width, height, out);
+            }
+            virtual void ReleaseInput() {}
+
+            // Decodes into a Frame. By default that is RGB24 in a pooled buffer;
+            // with native output enabled a backend may instead hand out its own
+            // planar YCbCr picture when the consumer can render it.
+            virtual bool DecodeToFrame(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength, Frame& out);
+            void SetNativeOutput(bool enabled) { m_nativeOutput = enabled; }
+
+            // DCT-domain downscale: 1 (full size), 2, 4 or 8
+            virtual void SetScaleDenominator(int denominator) = 0;
+            virtual int GetScaleDenominator() const = 0;
+
+            // "ffmpeg" or "turbojpeg"; throws if unknown or not compiled in
+            static std::unique_ptr<MjpgBackend> Create(const std::string& name);
+            static std::vector<std::string> Available();
+
+        protected:
+            bool m_nativeOutput = false;
+            FramePool m_framePool;
+    };
+
+} // namespace uvc2gl
+
+#endif // MJPGBACKEND_H
@@ -0,0 +1,128 @@
+// A/B benchmark of the MJPEG backends on a recorded corpus.
+// Record a corpus with StreamMjpg (frame_000.jpg, frame_001.jpg, ...), then:
+//   MjpgDecodeBench <dir> [passes] [scale]
+#include "MjpgBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace uvc2gl;
+
+static std::vector<std::vector<uint8_t>> LoadCorpus(const std::string& dir) {
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        auto ext = entry.path().extension().string();
+        if (entry.is_regular_file() && (ext == ".jpg" || ext == ".jpeg")) {
+            paths.push_back(entry.path());
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::vector<std::vector<uint8_t>> frames;
+    for (const auto& path : paths) {
+        std::ifstream in(path, std::ios::binary);
+        frames.emplace_back(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    return frames;
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+    size_t idx = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+    return sorted[idx];
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <corpus dir> [passes] [scale 1|2|4|8]" << std::endl;
+        return 1;
+    }
+    const std::string dir = argv[1];
+    const int passes = (argc >= 3) ? std::max(1, std::atoi(argv[2])) : 5;
+    const int scale = (argc >= 4) ? std::atoi(argv[3]) : 1;
+
+    std::vector<std::vector<uint8_t>> corpus;
+    try {
+        corpus = LoadCorpus(dir);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to read corpus: " << e.what() << std::endl;
+        return 1;
+    }
+    if (corpus.empty()) {
+        std::cerr << "No .jpg files in " << dir << std::endl;
+        return 1;
+    }
+    std::cout << "Corpus: " << corpus.size() << " frames, " << passes << " passes, scale 1/" << scale << std::endl;
+
+    std::cout << std::left << std::setw(12) << "backend"
+              << std::right << std::setw(10) << "size"
+              << std::setw(10) << "mean ms" << std::setw(10) << "p50 ms"
+              << std::setw(10) << "p99 ms" << std::setw(10) << "max ms"
+              << std::setw(10) << "fps" << std::setw(8) << "fail" << std::endl;
+
+    for (const auto& name : MjpgBackend::Available()) {
+        std::unique_ptr<MjpgBackend> backend;
+        try {
+            backend = MjpgBackend::Create(name);
+        } catch (const std::exception& e) {
+            std::cerr << name << ": " << e.what() << std::endl;
+            continue;
+        }
+        backend->SetScaleDenominator(scale);
+
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> rgb;
+        size_t failures = 0;
+
+        // Warm up: allocate scaler contexts and output buffers
+        backend->DecodeToRGB(corpus[0].data(), corpus[0].size(), width, height, rgb);
+
+        std::vector<double> latencies;
+        latencies.reserve(corpus.size() * passes);
+        for (int pass = 0; pass < passes; ++pass) {
+            for (const auto& jpeg : corpus) {
+                auto start = std::chrono::steady_clock::now();
+                bool ok = backend->DecodeToRGB(jpeg.data(), jpeg.size(), width, height, rgb);
+                auto end = std::chrono::steady_clock::now();
+                if (!ok) {
+                    ++failures;
+                    continue;
+                }
+                latencies.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+        }
+        if (latencies.empty()) {
+            std::cout << std::left << std::setw(12) << name << "all frames failed" << std::endl;
+            continue;
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        double total = 0.0;
+        for (double l : latencies) {
+            total += l;
+        }
+        double mean = total / latencies.size();
+
+        std::string size = std::to_string(width) + "x" + std::to_string(height);
+        std::cout << std::left << std::setw(12) << name
+                  << std::right << std::setw(10) << size
+                  << std::fixed << std::setprecision(3)
+                  << std::setw(10) << mean
+                  << std::setw(10) << Percentile(latencies, 0.50)
+                  << std::setw(10) << Percentile(latencies, 0.99)
+                  << std::setw(10) << latencies.back()
+                  << std::setprecision(1) << std::setw(10) << 1000.0 / mean
+                  << std::setw(8) << failures << std::endl;
+    }
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 #include "MjpgDecoder.h"
+#include "AVFrameStorage.h"
 #include "libswscale/swscale.h"
 #include <cstddef>
+#include <iostream>
 #include <stdexcept>
 #include <cstring>
 
@@ -10,14 +12,8 @@ extern "C" {
 
 namespace uvc2gl {
     MjpgDecoder::MjpgDecoder() {
-        const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
-        if (!codec)
-            throw std::runtime_error("MJPG decoder not found");
-        m_codecCtx = avcodec_alloc_context3(codec);
-        if (!m_codecCtx)
-            throw std::runtime_error("Failed to allocate codec context");
-        if (avcodec_open2(m_codecCtx, codec, nullptr) < 0)
-            throw std::runtime_error("Failed to open codec");
+        m_codecCtx = nullptr;
+        OpenCodec(0);
 
         m_frame = av_frame_alloc();
         m_packet = av_packet_alloc();
@@ -28,6 +24,10 @@ namespace uvc2gl {
     }
 
     MjpgDecoder::~MjpgDecoder(){
+        if (m_packet)
+            av_packet_unref(m_packet);
+        if (m_packetPool)
+            av_buffer_pool_uninit(&m_packetPool);
         if (m_swsCtx)
             sws_freeContext(m_swsCtx);
         if (m_frame)
@@ -38,6 +38,45 @@ namespace uvc2gl {
             avcodec_free_context(&m_codecCtx);
     }
 
+    void MjpgDecoder::OpenCodec(int lowres) {
+        const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_MJPEG);
+        if (!codec)
+            throw std::runtime_error("MJPG decoder not found");
+        AVCodecContext* ctx = avcodec_alloc_context3(codec);
+        if (!ctx)
+            throw std::runtime_error("Failed to allocate codec context");
+        // lowres must be set before opening; the MJPEG decoder then runs a
+        // reduced IDCT (8x8 -> 4x4/2x2/1x1) instead of decoding full size
+        ctx->lowres = lowres;
+        if (avcodec_open2(ctx, codec, nullptr) < 0) {
+            avcodec_free_context(&ctx);
+            throw std::runtime_error("Failed to open codec");
+        }
+        if (m_codecCtx)
+            avcodec_free_context(&m_codecCtx);
+        m_codecCtx = ctx;
+        m_lowres = lowres;
+    }
+
+    void MjpgDecoder::SetScaleDenominator(int denominator) {
+        int lowres = 0;
+        while (lowres < 3 && (2 << lowres) <= denominator)
+            ++lowres;
+        if (lowres == m_lowres || lowres == m_failedLowres)
+            return;
+
+        av_packet_unref(m_packet);
+        try {
+            OpenCodec(lowres);
+            m_failedLowres = -1;
+        } catch (const std::exception& e) {
+            // Keep decoding at the current scale and don't try this one again
+            // until a different scale has been asked for
+            std::cerr << "Failed to switch MJPEG decode scale: " << e.what() << std::endl;
+            m_failedLowres = lowres;
+        }
+    }
+
     void MjpgDecoder::ResetSwsContext(int width, int height, AVPixelFormat pixFmt) {
         if (m_swsCtx){
             sws_freeContext(m_swsCtx);
@@ -55,24 +94,134 @@ namespace uvc2gl {
         m_pixFmt = pixFmt;
     }
 
-    bool MjpgDecoder::DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out) {
+    bool MjpgDecoder::IsValidJpeg(const unsigned char* mjpgData, size_t mjpgSize) {
         if (mjpgSize < 4)
             return false;
         if (!(mjpgData[0] == 0xFF && mjpgData[1] == 0xD8)) // SOI
             return false;
         if (!(mjpgData[mjpgSize - 2] == 0xFF && mjpgData[mjpgSize - 1] == 0xD9)) // EOI
             return false;
+        return true;
+    }
+
+    void MjpgDecoder::OnBorrowedBufferFreed(void* opaque, uint8_t* /*data*/) {
+        // The memory belongs to the caller; just note that FFmpeg let go of it
+        static_cast<MjpgDecoder*>(opaque)->m_inputBorrowed = false;
+    }
+
+    bool MjpgDecoder::PreparePooledPacket(const unsigned char* mjpgData, size_t mjpgSize) {
+        size_t needed = mjpgSize + AV_INPUT_BUFFER_PADDING_SIZE;
+        if (!m_packetPool || needed > m_packetPoolSize) {
+            // Grow with headroom so small bitrate changes don't rebuild the pool.
+            // Buffers still in use keep the old pool alive until released.
+            if (m_packetPool)
+                av_buffer_pool_uninit(&m_packetPool);
+            m_packetPoolSize = needed + needed / 2;
+            m_packetPool = av_buffer_pool_init(m_packetPoolSize, nullptr);
+            if (!m_packetPool)
+                return false;
+        }
+
+        AVBufferRef* buf = av_buffer_pool_get(m_packetPool);
+        if (!buf)
+            return false;
+        std::memcpy(buf->data, mjpgData, mjpgSize);
+        std::memset(buf->data + mjpgSize, 0, AV_INPUT_BUFFER_PADDING_SIZE);
 
         av_packet_unref(m_packet);
-        if (av_new_packet(m_packet, mjpgSize) < 0)
+        m_packet->buf = buf;
+        m_packet->data = buf->data;
+        m_packet->size = static_cast<int>(mjpgSize);
+        return true;
+    }
+
+    bool MjpgDecoder::DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out) {
+        if (!IsValidJpeg(mjpgData, mjpgSize))
+            return false;
+        if (!PreparePooledPacket(mjpgData, mjpgSize))
+            return false;
+        return DecodePacket(width, height, out);
+    }
+
+    bool MjpgDecoder::DecodeToRGB(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength, int& width, int& height, std::vector<uint8_t>& out) {
+        if (!IsValidJpeg(mjpgData, mjpgSize))
+            return false;
+        if (!PrepareInputPacket(mjpgData, mjpgSize, bufferLength))
+            return false;
+        return DecodePacket(width, height, out);
+    }
+
+    bool MjpgDecoder::DecodeToFrame(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength, Frame& out) {
+        if (!m_nativeOutput)
+            return MjpgBackend::DecodeToFrame(mjpgData, mjpgSize, bufferLength, out);
+
+        if (!IsValidJpeg(mjpgData, mjpgSize))
+            return false;
+        if (!PrepareInputPacket(mjpgData, mjpgSize, bufferLength))
+            return false;
+        if (!ReceivePicture())
+            return false;
+
+        // 4:2:0 / 4:2:2 (nearly every UVC camera): hand out the decoder's own
+        // planes and skip swscale entirely
+        if (WrapAVFrame(m_frame, out))
+            return true;
+
+        // Anything else (4:4:4, greyscale) still goes through swscale
+        auto buffer = m_framePool.Acquire();
+        int width = 0;
+        int height = 0;
+        if (!ConvertPicture(width, height, *buffer))
             return false;
-        std::memcpy(m_packet->data, mjpgData, mjpgSize);
+        return FramePool::WrapBuffer(std::move(buffer), FrameFormat::RGB24, width, height, out);
+    }
+
+    bool MjpgDecoder::PrepareInputPacket(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength) {
+        if (bufferLength < mjpgSize + AV_INPUT_BUFFER_PADDING_SIZE) {
+            // No room for the bitstream reader's overread padding
+            return PreparePooledPacket(mjpgData, mjpgSize);
+        }
 
-        if (avcodec_send_packet(m_codecCtx, m_packet) < 0)
+        std::memset(mjpgData + mjpgSize, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+        AVBufferRef* buf = av_buffer_create(mjpgData, mjpgSize + AV_INPUT_BUFFER_PADDING_SIZE,
+                                            &MjpgDecoder::OnBorrowedBufferFreed, this, 0);
+        if (!buf)
             return false;
-        int ret = avcodec_receive_frame(m_codecCtx, m_frame);
+
+        av_packet_unref(m_packet);
+        m_inputBorrowed = true;
+        m_packet->buf = buf;
+        m_packet->data = mjpgData;
+        m_packet->size = static_cast<int>(mjpgSize);
+        return true;
+    }
+
+    void MjpgDecoder::ReleaseInput() {
+        av_packet_unref(m_packet);
+        if (m_inputBorrowed) {
+            // The decoder still holds the packet internally; flushing drops it
+            avcodec_flush_buffers(m_codecCtx);
+            if (m_inputBorrowed) {
+                std::cerr << "Warning: MJPEG decoder still references input buffer" << std::endl;
+                m_inputBorrowed = false;
+            }
+        }
+    }
+
+    bool MjpgDecoder::DecodePacket(int& width, int& height, std::vector<uint8_t>& out) {
+        return ReceivePicture() && ConvertPicture(width, height, out);
+    }
+
+    bool MjpgDecoder::ReceivePicture() {
+        int ret = avcodec_send_packet(m_codecCtx, m_packet);
+        av_packet_unref(m_packet); // the decoder holds its own reference
         if (ret < 0)
             return false;
+        ret = avcodec_receive_frame(m_codecCtx, m_frame);
+        return ret >= 0;
+    }
+
+    bool MjpgDecoder::ConvertPicture(int& width, int& height, std::vector<uint8_t>& out) {
         width = m_frame->width;
         height = m_frame->height;
 
@@ -1,6 +1,7 @@
 #ifndef MJPGDECODER_H
 #define MJPGDECODER_H
 
+#include "MjpgBackend.h"
 #include <cstdint>
 #include <vector>
 
@@ -12,20 +13,56 @@ extern "C" {
 
 namespace uvc2gl {
 
-    class MjpgDecoder{
+    // FFmpeg (libavcodec + libswscale) MJPEG backend
+    class MjpgDecoder : public MjpgBackend {
         public:
             MjpgDecoder();
-            ~MjpgDecoder();
+            ~MjpgDecoder() override;
 
             MjpgDecoder(const MjpgDecoder&) = delete;
             MjpgDecoder& operator=(const MjpgDecoder&) = delete;
 
-            bool DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out);
+            const char* Name() const override { return "ffmpeg"; }
+
+            // Copies the payload into a pooled, padded packet buffer
+            bool DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out) override;
+
+            // Zero-copy: wraps a caller-owned buffer (e.g. a V4L2 mmap buffer) in the
+            // packet when bufferLength leaves room for AV_INPUT_BUFFER_PADDING_SIZE,
+            // otherwise falls back to the pooled copy. The padding bytes are zeroed,
+            // so the buffer must be writable. Call ReleaseInput() before reusing it.
+            bool DecodeToRGB(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength, int& width, int& height, std::vector<uint8_t>& out) override;
+
+            // With native output, 4:2:0 and 4:2:2 JPEGs come back as I420/I422
+            // Frames referencing the decoder's AVFrame; no swscale pass
+            bool DecodeToFrame(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength, Frame& out) override;
+
+            // Drops every decoder reference to the last borrowed input buffer
+            void ReleaseInput() override;
+
+            // DCT-domain downscale: 1 (full size), 2, 4 or 8. Reopens the codec
+            // when the factor changes, so output dimensions shrink accordingly.
+            void SetScaleDenominator(int denominator) override;
+            int GetScaleDenominator() const override { return 1 << m_lowres; }
         private:
+            void OpenCodec(int lowres);
+            static bool IsValidJpeg(const unsigned char* mjpgData, size_t mjpgSize);
+            static void OnBorrowedBufferFreed(void* opaque, uint8_t* data);
+            bool PreparePooledPacket(const unsigned char* mjpgData, size_t mjpgSize);
+            bool PrepareInputPacket(uint8_t* mjpgData, size_t mjpgSize, size_t bufferLength);
+            bool DecodePacket(int& width, int& height, std::vector<uint8_t>& out);
+            bool ReceivePicture();
+            bool ConvertPicture(int& width, int& height, std::vector<uint8_t>& out);
+
             AVCodecContext* m_codecCtx;
             AVFrame* m_frame;
             AVPacket* m_packet;
             SwsContext* m_swsCtx;
+            AVBufferPool* m_packetPool = nullptr;
+            size_t m_packetPoolSize = 0;
+            bool m_inputBorrowed = false;
+            int m_lowres = 0;
+            int m_failedLowres = -1;  // Last lowres OpenCodec() couldn't open
 
             int m_width;
             int m_height;
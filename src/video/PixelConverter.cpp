@@ -0,0 +1,76 @@
+#include "PixelConverter.h"
+#include "../core/JobSystem.h"
+#include <linux/videodev2.h>
+#include <algorithm>
+
+namespace uvc2gl {
+
+    // Smallest band worth a job of its own: at 1080p about 120k pixels,
+    // long enough that handing it to another worker pays off
+    static constexpr int kMinBandRows = 64;
+
+    // One entry per (FourCC, matrix); each points at its own template instance
+    static const PixelConverter kConverters[] = {
+        { V4L2_PIX_FMT_YUYV,   ColorMatrix::BT601, &ConvertPacked422<0, 1, 2, 3, ColorMatrix::BT601> },
+        { V4L2_PIX_FMT_YUYV,   ColorMatrix::BT709, &ConvertPacked422<0, 1, 2, 3, ColorMatrix::BT709> },
+        { V4L2_PIX_FMT_UYVY,   ColorMatrix::BT601, &ConvertPacked422<1, 0, 3, 2, ColorMatrix::BT601> },
+        { V4L2_PIX_FMT_UYVY,   ColorMatrix::BT709, &ConvertPacked422<1, 0, 3, 2, ColorMatrix::BT709> },
+        { V4L2_PIX_FMT_NV12,   ColorMatrix::BT601, &ConvertPlanar420<true, false, ColorMatrix::BT601> },
+        { V4L2_PIX_FMT_NV12,   ColorMatrix::BT709, &ConvertPlanar420<true, false, ColorMatrix::BT709> },
+        { V4L2_PIX_FMT_NV21,   ColorMatrix::BT601, &ConvertPlanar420<true, true, ColorMatrix::BT601> },
+        { V4L2_PIX_FMT_NV21,   ColorMatrix::BT709, &ConvertPlanar420<true, true, ColorMatrix::BT709> },
+        { V4L2_PIX_FMT_YUV420, ColorMatrix::BT601, &ConvertPlanar420<false, false, ColorMatrix::BT601> },
+        { V4L2_PIX_FMT_YUV420, ColorMatrix::BT709, &ConvertPlanar420<false, false, ColorMatrix::BT709> },
+        { V4L2_PIX_FMT_YVU420, ColorMatrix::BT601, &ConvertPlanar420<false, true, ColorMatrix::BT601> },
+        { V4L2_PIX_FMT_YVU420, ColorMatrix::BT709, &ConvertPlanar420<false, true, ColorMatrix::BT709> },
+        // RGB formats have no colour matrix; registered under BT.601 only
+        { V4L2_PIX_FMT_RGB24,  ColorMatrix::BT601, &ConvertRgb24<false> },
+        { V4L2_PIX_FMT_BGR24,  ColorMatrix::BT601, &ConvertRgb24<true> },
+        { V4L2_PIX_FMT_GREY,   ColorMatrix::BT601, &ConvertGrey },
+    };
+
+    bool PixelConverter::Convert(const uint8_t* src, size_t size, int width, int height, int stride,
+                                 std::vector<uint8_t>& out, JobSystem* jobs) const {
+        if (!convertRows(src, size, width, height, stride, nullptr, 0, 0))
+            return false;
+        out.resize(static_cast<size_t>(width) * height * 3);
+
+        const int bands = jobs ? std::min(static_cast<int>(jobs->WorkerCount()), height / kMinBandRows) : 1;
+        if (bands <= 1)
+            return convertRows(src, size, width, height, stride, out.data(), 0, height);
+
+        jobs->ParallelFor(static_cast<size_t>(bands), [&](size_t band) {
+            const int begin = static_cast<int>(static_cast<int64_t>(height) * band / bands);
+            const int end = static_cast<int>(static_cast<int64_t>(height) * (band + 1) / bands);
+            convertRows(src, size, width, height, stride, out.data(), begin, end);
+        });
+        return true;
+    }
+
+    const PixelConverter* PixelConverterRegistry::Find(uint32_t fourcc, ColorMatrix matrix) {
+        const PixelConverter* fallback = nullptr;
+        for (const auto& converter : kConverters) {
+            if (converter.fourcc != fourcc)
+                continue;
+            if (converter.matrix == matrix)
+                return &converter;
+            if (!fallback)
+                fallback = &converter;
+        }
+        return fallback;
+    }
+
+    bool PixelConverterRegistry::IsSupported(uint32_t fourcc) {
+        return Find(fourcc) != nullptr;
+    }
+
+    std::vector<uint32_t> PixelConverterRegistry::SupportedFormats() {
+        std::vector<uint32_t> formats;
+        for (const auto& converter : kConverters) {
+            if (formats.empty() || formats.back() != converter.fourcc)
+                formats.push_back(converter.fourcc);
+        }
+        return formats;
+    }
+
+} // namespace uvc2gl
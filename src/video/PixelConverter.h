@@ -0,0 +1,40 @@
+#ifndef PIXELCONVERTER_H
+#define PIXELCONVERTER_H
+
+#include "PixelKernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace uvc2gl {
+
+    class JobSystem;
+
+    // Converts a range of rows of one raw V4L2 buffer to packed RGB24 (see PixelKernels.h)
+    using PixelConvertFn = bool (*)(const uint8_t* src, size_t size, int width, int height, int stride,
+                                    uint8_t* out, int rowBegin, int rowEnd);
+
+    struct PixelConverter {
+        uint32_t fourcc;
+        ColorMatrix matrix;
+        PixelConvertFn convertRows;
+
+        // Whole buffer into out, resized to fit. With a job system, bands of
+        // rows are spread over its workers (the caller converts one too).
+        bool Convert(const uint8_t* src, size_t size, int width, int height, int stride, std::vector<uint8_t>& out,
+                     JobSystem* jobs = nullptr) const;
+    };
+
+    // Registry of uncompressed pixel formats, keyed by V4L2 FourCC.
+    // MJPEG is not in here - it goes through MjpgBackend.
+    class PixelConverterRegistry {
+    public:
+        // nullptr if the format has no converter
+        static const PixelConverter* Find(uint32_t fourcc, ColorMatrix matrix = ColorMatrix::BT601);
+        static bool IsSupported(uint32_t fourcc);
+        static std::vector<uint32_t> SupportedFormats();
+    };
+
+} // namespace uvc2gl
+
+#endif // PIXELCONVERTER_H
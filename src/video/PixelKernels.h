@@ -0,0 +1,162 @@
+#ifndef PIXELKERNELS_H
+#define PIXELKERNELS_H
+
+#include "ColorMatrix.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace uvc2gl {
+
+    // 8.8 fixed-point limited-range YCbCr -> RGB coefficients
+    template <ColorMatrix M> struct YuvCoeffs;
+
+    template <> struct YuvCoeffs<ColorMatrix::BT601> {
+        static constexpr int Y = 298, RV = 409, GU = -100, GV = -208, BU = 516;
+    };
+
+    template <> struct YuvCoeffs<ColorMatrix::BT709> {
+        static constexpr int Y = 298, RV = 459, GU = -55, GV = -136, BU = 541;
+    };
+
+    template <> struct YuvCoeffs<ColorMatrix::BT2020> {
+        static constexpr int Y = 298, RV = 430, GU = -48, GV = -167, BU = 548;
+    };
+
+    template <ColorMatrix M>
+    inline void YuvToRgb(int y, int d, int e, uint8_t* dst) {
+        using C = YuvCoeffs<M>;
+        const int c = C::Y * (y - 16) + 128;
+        dst[0] = static_cast<uint8_t>(std::clamp((c + C::RV * e) >> 8, 0, 255));
+        dst[1] = static_cast<uint8_t>(std::clamp((c + C::GU * d + C::GV * e) >> 8, 0, 255));
+        dst[2] = static_cast<uint8_t>(std::clamp((c + C::BU * d) >> 8, 0, 255));
+    }
+
+    // Every kernel converts rows [rowBegin, rowEnd) of a single V4L2 buffer
+    // to tightly packed RGB24, at the same rows of out (width * height * 3
+    // bytes). Rows are independent, so bands of them can run in parallel.
+    // Returns false if the buffer is too small for the whole frame; an empty
+    // range only checks that. stride is bytesperline of the first plane as
+    // reported by VIDIOC_S_FMT.
+
+    // Packed 4:2:2, two pixels per 4 bytes. Byte offsets are template
+    // parameters so YUYV and UYVY each get their own unrolled loop.
+    template <int Y0, int U, int Y1, int V, ColorMatrix M>
+    bool ConvertPacked422(const uint8_t* src, size_t size, int width, int height, int stride, uint8_t* out, int rowBegin, int rowEnd) {
+        if (!src || width <= 0 || height <= 0)
+            return false;
+        if (stride < width * 2)
+            stride = width * 2;
+        if (size < static_cast<size_t>(stride) * (height - 1) + static_cast<size_t>(width) * 2)
+            return false;
+
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            const uint8_t* s = src + static_cast<size_t>(row) * stride;
+            uint8_t* dst = out + static_cast<size_t>(row) * width * 3;
+            for (int x = 0; x < width / 2; ++x) {
+                const int d = s[U] - 128;
+                const int e = s[V] - 128;
+                YuvToRgb<M>(s[Y0], d, e, dst);
+                YuvToRgb<M>(s[Y1], d, e, dst + 3);
+                s += 4;
+                dst += 6;
+            }
+        }
+        return true;
+    }
+
+    // 4:2:0 with a full-resolution Y plane followed by chroma. Interleaved
+    // selects NV12-style CbCr pairs over separate Cb/Cr planes (I420);
+    // SwapUV flips the chroma order (NV21 / YV12).
+    template <bool Interleaved, bool SwapUV, ColorMatrix M>
+    bool ConvertPlanar420(const uint8_t* src, size_t size, int width, int height, int stride, uint8_t* out, int rowBegin, int rowEnd) {
+        if (!src || width <= 0 || height <= 0)
+            return false;
+        if (stride < width)
+            stride = width;
+        const int chromaHeight = (height + 1) / 2;
+        const int chromaStride = Interleaved ? stride : stride / 2;
+        const size_t lumaSize = static_cast<size_t>(stride) * height;
+        const size_t chromaPlaneSize = static_cast<size_t>(chromaStride) * chromaHeight;
+        if (size < lumaSize + chromaPlaneSize * (Interleaved ? 1 : 2))
+            return false;
+
+        const uint8_t* luma = src;
+        const uint8_t* chroma0 = src + lumaSize;
+        const uint8_t* chroma1 = chroma0 + chromaPlaneSize;
+
+        uint8_t* dst = out + static_cast<size_t>(rowBegin) * width * 3;
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            const uint8_t* y = luma + static_cast<size_t>(row) * stride;
+            const uint8_t* c0 = chroma0 + static_cast<size_t>(row / 2) * chromaStride;
+            const uint8_t* c1 = chroma1 + static_cast<size_t>(row / 2) * chromaStride;
+            for (int x = 0; x < width; ++x) {
+                int cb, cr;
+                if constexpr (Interleaved) {
+                    cb = c0[(x & ~1) + (SwapUV ? 1 : 0)];
+                    cr = c0[(x & ~1) + (SwapUV ? 0 : 1)];
+                } else {
+                    cb = SwapUV ? c1[x / 2] : c0[x / 2];
+                    cr = SwapUV ? c0[x / 2] : c1[x / 2];
+                }
+                YuvToRgb<M>(y[x], cb - 128, cr - 128, dst);
+                dst += 3;
+            }
+        }
+        return true;
+    }
+
+    // Packed 24-bit RGB; SwapRB handles BGR24
+    template <bool SwapRB>
+    bool ConvertRgb24(const uint8_t* src, size_t size, int width, int height, int stride, uint8_t* out, int rowBegin, int rowEnd) {
+        if (!src || width <= 0 || height <= 0)
+            return false;
+        const size_t rowBytes = static_cast<size_t>(width) * 3;
+        if (static_cast<size_t>(stride) < rowBytes)
+            stride = static_cast<int>(rowBytes);
+        if (size < static_cast<size_t>(stride) * (height - 1) + rowBytes)
+            return false;
+
+        uint8_t* dst = out + static_cast<size_t>(rowBegin) * rowBytes;
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            const uint8_t* s = src + static_cast<size_t>(row) * stride;
+            if constexpr (SwapRB) {
+                for (int x = 0; x < width; ++x) {
+                    dst[0] = s[2];
+                    dst[1] = s[1];
+                    dst[2] = s[0];
+                    s += 3;
+                    dst += 3;
+                }
+            } else {
+                std::memcpy(dst, s, rowBytes);
+                dst += rowBytes;
+            }
+        }
+        return true;
+    }
+
+    // 8-bit greyscale, full range
+    inline bool ConvertGrey(const uint8_t* src, size_t size, int width, int height, int stride, uint8_t* out, int rowBegin, int rowEnd) {
+        if (!src || width <= 0 || height <= 0)
+            return false;
+        if (stride < width)
+            stride = width;
+        if (size < static_cast<size_t>(stride) * (height - 1) + width)
+            return false;
+
+        uint8_t* dst = out + static_cast<size_t>(rowBegin) * width * 3;
+        for (int row = rowBegin; row < rowEnd; ++row) {
+            const uint8_t* s = src + static_cast<size_t>(row) * stride;
+            for (int x = 0; x < width; ++x) {
+                dst[0] = dst[1] = dst[2] = s[x];
+                dst += 3;
+            }
+        }
+        return true;
+    }
+
+} // namespace uvc2gl
+
+#endif // PIXELKERNELS_H
@@ -0,0 +1,53 @@
+#include "TurboJpegDecoder.h"
+#include <stdexcept>
+
+namespace uvc2gl {
+
+    TurboJpegDecoder::TurboJpegDecoder() {
+        m_handle = tjInitDecompress();
+        if (!m_handle)
+            throw std::runtime_error("Failed to initialize TurboJPEG decompressor");
+    }
+
+    TurboJpegDecoder::~TurboJpegDecoder() {
+        if (m_handle)
+            tjDestroy(m_handle);
+    }
+
+    void TurboJpegDecoder::SetScaleDenominator(int denominator) {
+        int scale = 1;
+        while (scale < 8 && scale * 2 <= denominator)
+            scale *= 2;
+        m_scaleDenominator = scale;
+    }
+
+    bool TurboJpegDecoder::DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out) {
+        if (mjpgSize < 4)
+            return false;
+        if (!(mjpgData[0] == 0xFF && mjpgData[1] == 0xD8)) // SOI
+            return false;
+
+        int jpegWidth = 0;
+        int jpegHeight = 0;
+        int subsamp = 0;
+        int colorspace = 0;
+        if (tjDecompressHeader3(m_handle, mjpgData, static_cast<unsigned long>(mjpgSize),
+                                &jpegWidth, &jpegHeight, &subsamp, &colorspace) < 0)
+            return false;
+
+        // tjDecompress2 picks the scaling factor that fits the requested size
+        tjscalingfactor factor = { 1, m_scaleDenominator };
+        width = TJSCALED(jpegWidth, factor);
+        height = TJSCALED(jpegHeight, factor);
+
+        out.resize((size_t)width * (size_t)height * 3);
+        if (tjDecompress2(m_handle, mjpgData, static_cast<unsigned long>(mjpgSize),
+                          out.data(), width, width * 3, height, TJPF_RGB, TJFLAG_FASTDCT) < 0) {
+            // Warnings (e.g. premature end of data from a truncated UVC
+            // payload) still produce a complete image
+            return tjGetErrorCode(m_handle) == TJERR_WARNING;
+        }
+        return true;
+    }
+
+} // namespace uvc2gl
@@ -0,0 +1,37 @@
+#ifndef TURBOJPEGDECODER_H
+#define TURBOJPEGDECODER_H
+
+#include "MjpgBackend.h"
+#include <cstdint>
+#include <vector>
+
+#include <turbojpeg.h>
+
+namespace uvc2gl {
+
+    // libjpeg-turbo MJPEG backend: decode and SIMD colour conversion to RGB24
+    // in a single tjDecompress2 call, with native 1/2, 1/4, 1/8 IDCT scaling
+    class TurboJpegDecoder : public MjpgBackend {
+        public:
+            TurboJpegDecoder();
+            ~TurboJpegDecoder() override;
+
+            TurboJpegDecoder(const TurboJpegDecoder&) = delete;
+            TurboJpegDecoder& operator=(const TurboJpegDecoder&) = delete;
+
+            const char* Name() const override { return "turbojpeg"; }
+
+            using MjpgBackend::DecodeToRGB;
+            bool DecodeToRGB(const unsigned char* mjpgData, size_t mjpgSize, int& width, int& height, std::vector<uint8_t>& out) override;
+
+            void SetScaleDenominator(int denominator) override;
+            int GetScaleDenominator() const override { return m_scaleDenominator; }
+
+        private:
+            tjhandle m_handle;
+            int m_scaleDenominator = 1;
+    };
+
+} // namespace uvc2gl
+
+#endif // TURBOJPEGDECODER_H
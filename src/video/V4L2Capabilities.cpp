@@ -27,9 +27,15 @@ std::vector<VideoFormat> V4L2Capabilities::QueryFormats(const std::string& devic
         return formats;
     }
     
+    uint32_t bufType = CaptureBufferType(fd);
+    if (bufType == 0) {
+        close(fd);
+        return formats;
+    }
+
     // Enumerate all supported pixel formats
     v4l2_fmtdesc fmtdesc{};
-    fmtdesc.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmtdesc.type = bufType;
     fmtdesc.index = 0;
     
     while (xioctl(fd, VIDIOC_ENUM_FMT, &fmtdesc) == 0) {
@@ -92,12 +98,14 @@ std::vector<VideoDevice> V4L2Capabilities::EnumerateDevices() {
             
             v4l2_capability caps{};
             if (xioctl(fd, VIDIOC_QUERYCAP, &caps) >= 0) {
-                // Check if it's a video capture device
-                if (caps.capabilities & V4L2_CAP_VIDEO_CAPTURE) {
+                // Check if it's a video capture device (single or multi-planar)
+                uint32_t bufType = CaptureBufferType(fd);
+                if (bufType != 0) {
                     VideoDevice device;
                     device.path = path;
                     device.name = reinterpret_cast<const char*>(caps.card);
                     device.driver = reinterpret_cast<const char*>(caps.driver);
+                    device.multiplanar = (bufType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
                     devices.push_back(device);
                 }
             }
@@ -110,4 +118,48 @@ std::vector<VideoDevice> V4L2Capabilities::EnumerateDevices() {
     return devices;
 }
 
+uint32_t V4L2Capabilities::CaptureBufferType(int fd) {
+    v4l2_capability caps{};
+    if (xioctl(fd, VIDIOC_QUERYCAP, &caps) < 0) {
+        return 0;
+    }
+    // capabilities covers the whole physical device; device_caps is this node
+    uint32_t nodeCaps = (caps.capabilities & V4L2_CAP_DEVICE_CAPS) ? caps.device_caps : caps.capabilities;
+    if (nodeCaps & V4L2_CAP_VIDEO_CAPTURE) {
+        return V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    }
+    if (nodeCaps & V4L2_CAP_VIDEO_CAPTURE_MPLANE) {
+        return V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
+    }
+    return 0;
+}
+
+std::string V4L2Capabilities::FormatName(uint32_t pixelFormat) {
+    if (pixelFormat == V4L2_PIX_FMT_MJPEG) {
+        return "MJPEG";
+    }
+    std::string name;
+    for (int i = 0; i < 4; ++i) {
+        char c = static_cast<char>((pixelFormat >> (8 * i)) & 0xFF);
+        if (c != ' ') {
+            name += c;
+        }
+    }
+    return name;
+}
+
+uint32_t V4L2Capabilities::PixelFormatFromName(const std::string& name) {
+    if (name == "MJPEG" || name == "MJPG") {
+        return V4L2_PIX_FMT_MJPEG;
+    }
+    if (name.empty() || name.size() > 4) {
+        return 0;
+    }
+    char c[4] = { ' ', ' ', ' ', ' ' };
+    for (size_t i = 0; i < name.size(); ++i) {
+        c[i] = name[i];
+    }
+    return v4l2_fourcc(c[0], c[1], c[2], c[3]);
+}
+
 }
@@ -22,6 +22,7 @@ struct VideoDevice {
     std::string path;           // e.g., "/dev/video0"
     std::string name;           // Device name from capabilities
     std::string driver;         // Driver name
+    bool multiplanar = false;   // Only exposes a VIDEO_CAPTURE_MPLANE queue
     
     std::string toString() const {
         return name + " (" + path + ")";
@@ -36,6 +37,16 @@ class V4L2Capabilities {
 public:
     static std::vector<VideoFormat> QueryFormats(const std::string& device);
     static std::vector<VideoDevice> EnumerateDevices();
+
+    // V4L2_BUF_TYPE_VIDEO_CAPTURE, or V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE for
+    // drivers that only have a multi-planar queue. 0 if the open device
+    // can't capture at all.
+    static uint32_t CaptureBufferType(int fd);
+
+    // Format names as used in the UI and config: "MJPEG" for Motion-JPEG,
+    // otherwise the four FourCC characters (e.g. "YUYV", "NV12", "RGB3")
+    static std::string FormatName(uint32_t pixelFormat);
+    static uint32_t PixelFormatFromName(const std::string& name);
 };
 
 }
@@ -1,20 +1,31 @@
 #include "VideoCapture.h"
+#include "Fingerprint.h"
 #include "Frame.h"
+#include "V4L2Capabilities.h"
 
 #include <bits/types/struct_timeval.h>
 #include <cstdint>
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <mutex>
 #include <stdexcept>
 #include <vector>
+// Packed 10-bit 4:2:2; missing from older kernel headers
+#ifndef V4L2_PIX_FMT_Y210
+#define V4L2_PIX_FMT_Y210 v4l2_fourcc('Y', '2', '1', '0')
+#endif
+
 namespace uvc2gl {
     //ioctl wrapper that restarts if interrupted by signal
     static int xioctl(int fd, unsigned long request, void *arg) {
@@ -31,11 +42,232 @@ namespace uvc2gl {
         size_t length = 0;
     };
 
-    VideoCapture::VideoCapture(std::string device, int width, int height, int fps, std::string format, size_t ringBufferSize)
+    // One V4L2 buffer; single-planar queues only use planes[0]
+    struct MappedBuffer {
+        Buffer planes[VIDEO_MAX_PLANES];
+    };
+
+    // The fd and mappings of one streaming session. Frames that lease a V4L2
+    // buffer share ownership, so the memory stays mapped until the last lease
+    // is dropped even if capture has stopped. Returned buffers are re-queued
+    // by the reactor handler that returnFd wakes.
+    struct StreamBuffers {
+        int fd = -1;
+        uint32_t numPlanes = 1;
+        std::vector<MappedBuffer> buffers;
+        std::atomic<uint32_t> leased{0};
+        std::mutex returnedMutex;
+        std::vector<uint32_t> returned;
+        int returnFd = -1; // eventfd signalled when a lease is dropped
+
+        StreamBuffers() = default;
+        StreamBuffers(const StreamBuffers&) = delete;
+        StreamBuffers& operator=(const StreamBuffers&) = delete;
+
+        ~StreamBuffers() {
+            for (auto& buffer : buffers) {
+                for (uint32_t p = 0; p < numPlanes; ++p) {
+                    if (buffer.planes[p].start && buffer.planes[p].start != MAP_FAILED)
+                        munmap(buffer.planes[p].start, buffer.planes[p].length);
+                }
+            }
+            if (returnFd >= 0)
+                close(returnFd);
+            if (fd >= 0)
+                close(fd);
+        }
+
+        std::vector<uint32_t> TakeReturned() {
+            std::lock_guard<std::mutex> lock(returnedMutex);
+            std::vector<uint32_t> indices;
+            indices.swap(returned);
+            return indices;
+        }
+    };
+
+    // Frame storage that holds V4L2 buffer `index` out of the queue
+    static std::shared_ptr<const void> LeaseBuffer(const std::shared_ptr<StreamBuffers>& stream, uint32_t index) {
+        stream->leased.fetch_add(1, std::memory_order_relaxed);
+        return std::shared_ptr<const void>(stream->buffers[index].planes[0].start, [stream, index](const void*) {
+            {
+                std::lock_guard<std::mutex> lock(stream->returnedMutex);
+                stream->returned.push_back(index);
+            }
+            stream->leased.fetch_sub(1, std::memory_order_relaxed);
+            uint64_t one = 1;
+            if (write(stream->returnFd, &one, sizeof(one)) < 0)
+                std::cerr << "Error signalling returned buffer: " << strerror(errno) << std::endl;
+        });
+    }
+
+    // Payload of one dequeued V4L2 buffer
+    struct DequeuedBuffer {
+        uint32_t index = 0;
+        uint8_t* data[VIDEO_MAX_PLANES] = {};
+        size_t size[VIDEO_MAX_PLANES] = {};
+        size_t capacity[VIDEO_MAX_PLANES] = {};
+        int64_t captureTimeNs = 0;
+    };
+
+    // What VIDIOC_S_FMT settled on, for either queue type
+    struct NegotiatedFormat {
+        uint32_t pixelFormat = 0;
+        int width = 0;
+        int height = 0;
+        uint32_t numPlanes = 1;
+        int stride[VIDEO_MAX_PLANES] = {};
+        uint32_t colorspace = 0;
+        uint32_t ycbcrEnc = 0;
+        uint32_t quantization = 0;
+    };
+
+    static NegotiatedFormat ReadFormat(const v4l2_format& fmt) {
+        NegotiatedFormat out;
+        if (fmt.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE) {
+            const v4l2_pix_format_mplane& mp = fmt.fmt.pix_mp;
+            out.pixelFormat = mp.pixelformat;
+            out.width = static_cast<int>(mp.width);
+            out.height = static_cast<int>(mp.height);
+            out.numPlanes = std::clamp<uint32_t>(mp.num_planes, 1, VIDEO_MAX_PLANES);
+            for (uint32_t p = 0; p < out.numPlanes; ++p)
+                out.stride[p] = static_cast<int>(mp.plane_fmt[p].bytesperline);
+            out.colorspace = mp.colorspace;
+            out.ycbcrEnc = mp.ycbcr_enc;
+            out.quantization = mp.quantization;
+        } else {
+            const v4l2_pix_format& pix = fmt.fmt.pix;
+            out.pixelFormat = pix.pixelformat;
+            out.width = static_cast<int>(pix.width);
+            out.height = static_cast<int>(pix.height);
+            out.stride[0] = static_cast<int>(pix.bytesperline);
+            out.colorspace = pix.colorspace;
+            out.ycbcrEnc = pix.ycbcr_enc;
+            out.quantization = pix.quantization;
+        }
+        return out;
+    }
+
+    // One streaming session: the device set up by OpenSession, shared by the
+    // reactor handlers and the decode jobs that reference it
+    struct CaptureSession {
+        std::shared_ptr<StreamBuffers> stream;
+        uint32_t bufType = 0;
+        bool multiplanar = false;
+        NegotiatedFormat negotiated;
+        bool isMjpeg = false;
+        bool isH264 = false;
+        bool isPassthrough = false;
+        FrameFormat frameFormat = FrameFormat::RGB24;
+        ColorMatrix matrix = ColorMatrix::BT601;
+        bool fullRange = false;
+        const PixelConverter* converter = nullptr;
+        uint32_t bufferCount = 0;
+        std::shared_ptr<DecodeStrand> strand;
+        int deviceId = -1;  // IoReactor registrations
+        int returnId = -1;
+
+        // Set by the reactor when an H.264 access unit is dropped undecoded,
+        // and for a new stream; the decode side then flushes the decoder and
+        // waits for an IDR
+        std::atomic<bool> h264Resync{true};
+        bool keyFrameControl = true; // Decode side: FORCE_KEY_FRAME not rejected yet
+
+        // Reactor thread only
+        int warmupFrames = 0;
+        uint32_t queued = 0; // Buffers the driver holds
+        bool deviceArmed = true;
+
+        // Fingerprint of the last successfully decoded MJPEG payload; only
+        // touched by DecodeBuffer, which never runs twice at once
+        bool haveLastPayload = false;
+        uint64_t lastFingerprint = 0;
+        size_t lastPayloadSize = 0;
+
+        int QueueBuffer(uint32_t index) {
+            v4l2_plane planes[VIDEO_MAX_PLANES]{};
+            v4l2_buffer buff{};
+            buff.type = bufType;
+            buff.memory = V4L2_MEMORY_MMAP;
+            buff.index = index;
+            if (multiplanar) {
+                buff.m.planes = planes;
+                buff.length = stream->numPlanes;
+            }
+            int r = xioctl(stream->fd, VIDIOC_QBUF, &buff);
+            if (r == 0)
+                queued++;
+            return r;
+        }
+
+        // A buffer is being thrown away without decoding
+        void Dropped() {
+            if (isH264)
+                h264Resync.store(true, std::memory_order_relaxed);
+        }
+    };
+
+    // Formats the renderer takes as-is (Y + CbCr textures, or a packed 4:2:2
+    // texture) and converts in the shader; false for everything else
+    static bool PassthroughFormat(uint32_t pixelFormat, FrameFormat& format) {
+        switch (pixelFormat) {
+            case V4L2_PIX_FMT_NV12:
+            case V4L2_PIX_FMT_NV12M:
+                format = FrameFormat::NV12;
+                return true;
+            case V4L2_PIX_FMT_NV16:
+            case V4L2_PIX_FMT_NV16M:
+                format = FrameFormat::NV16;
+                return true;
+            case V4L2_PIX_FMT_P010:
+                format = FrameFormat::P010;
+                return true;
+            case V4L2_PIX_FMT_Y210:
+                format = FrameFormat::Y210;
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // Points a Frame's planes into a dequeued V4L2 buffer, keeping the
+    // driver's row padding. Planes beyond the V4L2 plane count follow the
+    // previous one in the same memory (NV12's CbCr after Y); two-plane
+    // layouts like NV12M carry CbCr in V4L2 plane 1.
+    static bool DescribeV4L2Planes(const uint8_t* const* planes, const size_t* sizes, uint32_t numPlanes,
+                                   const int* strides, Frame& frame) {
+        FramePlane layout[kMaxFramePlanes];
+        const int count = FramePlaneGeometry(frame.format, frame.width, frame.height, layout);
+        const uint8_t* next = nullptr;
+        size_t remaining = 0;
+        for (int p = 0; p < count; ++p) {
+            const bool ownPlane = static_cast<uint32_t>(p) < numPlanes;
+            const uint8_t* base = ownPlane ? planes[p] : next;
+            const size_t available = ownPlane ? sizes[p] : remaining;
+            const int stride = std::max(ownPlane ? strides[p] : strides[0], layout[p].rowBytes);
+            layout[p].stride = stride;
+            if (!base || available < layout[p].Size())
+                return false;
+            layout[p].data = base;
+
+            const size_t planeBytes = static_cast<size_t>(stride) * layout[p].rows;
+            next = base + planeBytes;
+            remaining = available > planeBytes ? available - planeBytes : 0;
+        }
+        frame.planeCount = count;
+        for (int p = 0; p < count; ++p)
+            frame.planes[p] = layout[p];
+        return true;
+    }
+
+    VideoCapture::VideoCapture(std::string device, int width, int height, int fps, std::string format,
+                               const std::string& mjpegBackend)
         : m_Device(std::move(device)), m_Width(width), m_Height(height), m_FPS(fps), m_Format(std::move(format)) {
-        m_RingBuffer = std::make_unique<RingBuffer>(ringBufferSize);
-        m_mjpegDecoder = std::make_unique<MjpgDecoder>();
-        m_yuyvDecoder = std::make_unique<YuyvDecoder>();
+        m_mjpegDecoder = MjpgBackend::Create(mjpegBackend);
+        m_PixelFormat = V4L2Capabilities::PixelFormatFromName(m_Format);
+        if (!SupportsFormat(m_PixelFormat))
+            throw std::runtime_error("Unsupported video format: " + m_Format);
+        if (m_PixelFormat == V4L2_PIX_FMT_H264)
+            m_h264Decoder = std::make_unique<H264Decoder>();
         m_Running = false;
     }
 
@@ -51,53 +283,155 @@ namespace uvc2gl {
     void VideoCapture::Start() {
         if (m_Running.exchange(true))
             return; // already running
-        m_CaptureThread = std::thread(&VideoCapture::CaptureLoop, this);
+
+        std::shared_ptr<CaptureSession> session;
+        try {
+            if (!m_Reactor)
+                m_Reactor = std::make_shared<IoReactor>(); // standalone: a reactor thread of our own
+            session = OpenSession();
+
+            // Registered idle and armed once the id is stored, so the
+            // handler never sees a half-initialised session
+            session->returnId = m_Reactor->Add(session->stream->returnFd, EPOLLIN,
+                                               [this, session](uint32_t) { OnBuffersReturned(session); });
+            session->deviceId = m_Reactor->Add(session->stream->fd, 0,
+                                               [this, session](uint32_t events) { OnDeviceReady(session, events); });
+            if (session->returnId < 0 || session->deviceId < 0 || !m_Reactor->Modify(session->deviceId, EPOLLIN))
+                throw std::runtime_error("Failed to watch " + m_Device);
+            m_Session = std::move(session);
+        } catch (const std::exception& e) {
+            std::cerr << "Video capture error: " << e.what() << std::endl;
+            if (session) {
+                m_Reactor->Remove(session->deviceId);
+                m_Reactor->Remove(session->returnId);
+            }
+            m_Running = false;
+        }
     }
 
     void VideoCapture::Stop(){
-        if (!m_Running.exchange(false))
+        m_Running = false;
+        std::shared_ptr<CaptureSession> session = std::move(m_Session);
+        if (!session)
             return; // not running
-        
+
         try {
-            if (m_CaptureThread.joinable()) {
-                m_CaptureThread.join();
-            }
+            // Once these return no handler is running on the reactor, and
+            // after the flush no decode job is either
+            m_Reactor->Remove(session->deviceId);
+            m_Reactor->Remove(session->returnId);
+            if (session->strand)
+                session->strand->Flush();
+
+            v4l2_buf_type type = static_cast<v4l2_buf_type>(session->bufType);
+            xioctl(session->stream->fd, VIDIOC_STREAMOFF, &type);
+
+            // Drop queued Frames so leased V4L2 buffers are released and the
+            // device is closed before anyone reopens it; the stream unmaps
+            // the buffers and closes fd once the last lease is gone
+            m_Bus.Clear();
         } catch (const std::exception& e) {
-            std::cerr << "Error joining capture thread: " << e.what() << std::endl;
+            std::cerr << "Error stopping capture: " << e.what() << std::endl;
         } catch (...) {
-            std::cerr << "Unknown error joining capture thread" << std::endl;
+            std::cerr << "Unknown error stopping capture" << std::endl;
         }
     }
 
-    std::optional<Frame> VideoCapture::GetFrame() {
-        return m_RingBuffer->pop();
+    bool VideoCapture::SupportsFormat(uint32_t pixelFormat) {
+        FrameFormat passthrough;
+        return pixelFormat == V4L2_PIX_FMT_MJPEG || pixelFormat == V4L2_PIX_FMT_H264 ||
+               PassthroughFormat(pixelFormat, passthrough) || PixelConverterRegistry::IsSupported(pixelFormat);
     }
 
-    void VideoCapture::CaptureLoop(){
-        try {
-            int fd = open(m_Device.c_str(), O_RDWR | O_CLOEXEC); // Open device
-            if (fd < 0)
-                throw std::runtime_error("Error opening device " + m_Device + ": " + strerror(errno));
+    CaptureStats VideoCapture::GetStats() const {
+        CaptureStats stats;
+        stats.framesCaptured = m_FramesCaptured.load(std::memory_order_relaxed);
+        stats.framesDecoded = m_FramesDecoded.load(std::memory_order_relaxed);
+        stats.framesDuplicate = m_FramesDuplicate.load(std::memory_order_relaxed);
+        stats.framesFailed = m_FramesFailed.load(std::memory_order_relaxed);
+        stats.framesSuspended = m_FramesSuspended.load(std::memory_order_relaxed);
+        stats.framesOverrun = m_FramesOverrun.load(std::memory_order_relaxed);
+        stats.avgDecodeMs = m_AvgDecodeMs.load(std::memory_order_relaxed);
+        stats.avgCaptureLatencyMs = m_AvgCaptureLatencyMs.load(std::memory_order_relaxed);
+        stats.decodeScale = m_ActiveDecodeScale.load(std::memory_order_relaxed);
+        stats.subscribers = m_Bus.GetStats();
+        return stats;
+    }
+
+    std::shared_ptr<CaptureSession> VideoCapture::OpenSession(){
+        // Non-blocking: the reactor only calls us when a buffer is ready
+        int fd = open(m_Device.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC); // Open device
+        if (fd < 0)
+            throw std::runtime_error("Error opening device " + m_Device + ": " + strerror(errno));
+        auto session = std::make_shared<CaptureSession>();
+        // Owns fd and the mappings from here on
+        session->stream = std::make_shared<StreamBuffers>();
+        StreamBuffers& stream = *session->stream;
+        stream.fd = fd;
+        stream.returnFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (stream.returnFd < 0)
+            throw std::runtime_error("Error creating eventfd: " + std::string(strerror(errno)));
+
         // set format
+        const uint32_t bufType = V4L2Capabilities::CaptureBufferType(fd);
+        if (bufType == 0) {
+            throw std::runtime_error(m_Device + " is not a video capture device");
+        }
+        const bool multiplanar = (bufType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE);
+        session->bufType = bufType;
+        session->multiplanar = multiplanar;
 
         v4l2_format fmt{};
-        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-        fmt.fmt.pix.width = m_Width;
-        fmt.fmt.pix.height = m_Height;
-        if (m_Format == "YUYV") {
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_YUYV;
+        fmt.type = bufType;
+        if (multiplanar) {
+            fmt.fmt.pix_mp.width = m_Width;
+            fmt.fmt.pix_mp.height = m_Height;
+            fmt.fmt.pix_mp.pixelformat = m_PixelFormat;
+            fmt.fmt.pix_mp.field = V4L2_FIELD_ANY;
         } else {
-            fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_MJPEG;
+            fmt.fmt.pix.width = m_Width;
+            fmt.fmt.pix.height = m_Height;
+            fmt.fmt.pix.pixelformat = m_PixelFormat;
+            fmt.fmt.pix.field = V4L2_FIELD_ANY;
         }
-        fmt.fmt.pix.field = V4L2_FIELD_ANY;
         if (xioctl(fd, VIDIOC_S_FMT, &fmt) < 0) {
-            close(fd);
             throw std::runtime_error("Error setting format: " + std::string(strerror(errno)));
         }
+        session->negotiated = ReadFormat(fmt);
+        const NegotiatedFormat& negotiated = session->negotiated;
+        if (negotiated.pixelFormat != m_PixelFormat) {
+            throw std::runtime_error("Device does not support format " + m_Format);
+        }
+
+        // Raw formats: the driver may have adjusted size and row padding
+        session->isMjpeg = (m_PixelFormat == V4L2_PIX_FMT_MJPEG);
+        session->isH264 = (m_PixelFormat == V4L2_PIX_FMT_H264);
+        const FrameFormatMask accepted = m_OutputFormats.load(std::memory_order_relaxed);
+        session->isPassthrough = PassthroughFormat(m_PixelFormat, session->frameFormat);
+        if (session->isPassthrough && !(accepted & FrameFormatBit(session->frameFormat)) &&
+            PixelConverterRegistry::IsSupported(m_PixelFormat))
+            session->isPassthrough = false; // consumer can't render it; convert to RGB24 on the CPU
+        const FrameFormatMask planarYuv = FrameFormatBit(FrameFormat::I420) | FrameFormatBit(FrameFormat::I422);
+        m_mjpegDecoder->SetNativeOutput((accepted & planarYuv) == planarYuv);
+        if (m_h264Decoder)
+            m_h264Decoder->SetNativeOutput((accepted & planarYuv) == planarYuv);
+        const uint32_t numPlanes = negotiated.numPlanes;
+        if (negotiated.ycbcrEnc == V4L2_YCBCR_ENC_BT2020 || negotiated.colorspace == V4L2_COLORSPACE_BT2020)
+            session->matrix = ColorMatrix::BT2020;
+        else if (negotiated.ycbcrEnc == V4L2_YCBCR_ENC_709 || negotiated.colorspace == V4L2_COLORSPACE_REC709)
+            session->matrix = ColorMatrix::BT709;
+        session->fullRange = (negotiated.quantization == V4L2_QUANTIZATION_FULL_RANGE);
+        const bool compressed = session->isMjpeg || session->isH264;
+        session->converter = (compressed || session->isPassthrough) ? nullptr
+                             : PixelConverterRegistry::Find(m_PixelFormat, session->matrix);
+        if (!compressed && !session->isPassthrough && numPlanes > 1) {
+            throw std::runtime_error("Format " + m_Format + " has " + std::to_string(numPlanes) +
+                                     " planes; only single-plane layouts are supported");
+        }
 
         // Set framerate
         v4l2_streamparm parm{};
-        parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        parm.type = bufType;
         parm.parm.capture.timeperframe.numerator = 1;
         parm.parm.capture.timeperframe.denominator = m_FPS;
         if (xioctl(fd, VIDIOC_S_PARM, &parm) < 0) {
@@ -105,113 +439,306 @@ namespace uvc2gl {
             // Don't fail - some devices might not support this
         }
 
+        // Decode on the shared pool when there is one: one job in the pool
+        // at a time per source, the newest frame waiting behind it
+        if (m_DecoderPool)
+            session->strand = m_DecoderPool->CreateStrand(1);
+
         v4l2_requestbuffers reqBuffer{};
-        reqBuffer.count = 4; // Request 4 buffers
-        reqBuffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        // Request 4 buffers, plus headroom for Frames or pool jobs leasing one
+        reqBuffer.count = (session->isPassthrough || session->strand) ? 6 : 4;
+        reqBuffer.type = bufType;
         reqBuffer.memory = V4L2_MEMORY_MMAP;
         if (xioctl(fd, VIDIOC_REQBUFS, &reqBuffer) < 0) {
-            close(fd);
             throw std::runtime_error("Error requesting buffers: " + std::string(strerror(errno)));
         }
+        session->bufferCount = reqBuffer.count;
 
-        std::vector<Buffer> buffers(reqBuffer.count);
+        stream.numPlanes = numPlanes;
+        stream.buffers.resize(reqBuffer.count);
+        std::vector<MappedBuffer>& buffers = stream.buffers;
         for (size_t i = 0; i < reqBuffer.count; ++i){
+            v4l2_plane planes[VIDEO_MAX_PLANES]{};
             v4l2_buffer buff{};
-            buff.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            buff.type = bufType;
             buff.memory = V4L2_MEMORY_MMAP;
             buff.index = i;
+            if (multiplanar) {
+                buff.m.planes = planes;
+                buff.length = numPlanes;
+            }
             if (xioctl(fd, VIDIOC_QUERYBUF, &buff) < 0) {
-                close(fd);
                 throw std::runtime_error("Error querying buffer " + std::to_string(i) + ": " + std::string(strerror(errno)));
             }
-            buffers[i].length = buff.length;
-            buffers[i].start = mmap(nullptr, buff.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buff.m.offset);
-            if (buffers[i].start == MAP_FAILED) {
-                close(fd);
-                throw std::runtime_error("Error mapping buffer " + std::to_string(i) + ": " + std::string(strerror(errno)));
+            for (uint32_t p = 0; p < numPlanes; ++p) {
+                size_t length = multiplanar ? planes[p].length : buff.length;
+                off_t offset = multiplanar ? planes[p].m.mem_offset : buff.m.offset;
+                buffers[i].planes[p].length = length;
+                buffers[i].planes[p].start = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+                if (buffers[i].planes[p].start == MAP_FAILED) {
+                    throw std::runtime_error("Error mapping buffer " + std::to_string(i) + ": " + std::string(strerror(errno)));
+                }
             }
         }
 
         // Queue buffers
         for (size_t i = 0; i < reqBuffer.count; ++i){
-            v4l2_buffer buff{};
-            buff.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buff.memory = V4L2_MEMORY_MMAP;
-            buff.index = i;
-            if (xioctl(fd, VIDIOC_QBUF, &buff) < 0) {
-                close(fd);
+            if (session->QueueBuffer(i) < 0) {
                 throw std::runtime_error("Error queueing buffer " + std::to_string(i) + ": " + std::string(strerror(errno)));
             }
         }
 
         // Start streaming
-        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        v4l2_buf_type type = static_cast<v4l2_buf_type>(bufType);
         if (xioctl(fd, VIDIOC_STREAMON, &type) < 0) {
-            close(fd);
             throw std::runtime_error("Error starting streaming: " + std::string(strerror(errno)));
         }
 
-        int warmupFrames = m_FPS; // 1 second worth of frames
-        while(m_Running.load()){
-            fd_set fds;
-            FD_ZERO(&fds);
-            FD_SET(fd, &fds);
-            timeval tv {};
-            tv.tv_sec = 2; // 2 second timeout
-            tv.tv_usec = 0;
+        // 1 second worth of frames, except for H.264: the first access
+        // units carry the SPS/PPS and the IDR everything after refers to
+        session->warmupFrames = session->isH264 ? 0 : m_FPS;
+        return session;
+    }
 
-            int r = select(fd + 1, &fds, nullptr, nullptr, &tv);
-            if (r <= 0)
-                continue;
+    void VideoCapture::OnBuffersReturned(const std::shared_ptr<CaptureSession>& owner) {
+        CaptureSession& session = *owner;
+        uint64_t count;
+        while (read(session.stream->returnFd, &count, sizeof(count)) > 0) {
+        }
+        // Buffers whose Frames the consumer has dropped go back to the driver
+        for (uint32_t index : session.stream->TakeReturned()) {
+            if (session.QueueBuffer(index) < 0)
+                std::cerr << "Error re-queueing leased buffer: " << strerror(errno) << std::endl;
+        }
+        if (!session.deviceArmed && session.queued > 0)
+            session.deviceArmed = m_Reactor->Modify(session.deviceId, EPOLLIN);
+    }
 
-            v4l2_buffer buff{};
-            buff.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-            buff.memory = V4L2_MEMORY_MMAP;
+    void VideoCapture::OnDeviceReady(const std::shared_ptr<CaptureSession>& owner, uint32_t events) {
+        CaptureSession& session = *owner;
+        const int fd = session.stream->fd;
+        const uint32_t numPlanes = session.stream->numPlanes;
 
-            if (xioctl(fd, VIDIOC_DQBUF, &buff) < 0) {
-                std::cerr << "Error dequeueing buffer: " << strerror(errno) << std::endl;
-                continue;
+        v4l2_plane planes[VIDEO_MAX_PLANES]{};
+        v4l2_buffer buff{};
+        buff.type = session.bufType;
+        buff.memory = V4L2_MEMORY_MMAP;
+        if (session.multiplanar) {
+            buff.m.planes = planes;
+            buff.length = numPlanes;
+        }
+
+        if (xioctl(fd, VIDIOC_DQBUF, &buff) < 0) {
+            if (errno == EAGAIN) {
+                // V4L2 reports POLLERR while nothing is queued; stop
+                // watching until a leased buffer comes back
+                if ((events & EPOLLERR) && session.queued == 0)
+                    session.deviceArmed = !m_Reactor->Modify(session.deviceId, 0);
+                return;
+            }
+            std::cerr << "Error dequeueing buffer: " << strerror(errno) << std::endl;
+            // The device is gone (unplugged, driver error); stop watching it
+            if (events & (EPOLLERR | EPOLLHUP)) {
+                m_Reactor->Remove(session.deviceId);
+                m_Running = false;
             }
+            return;
+        }
+        session.queued--;
+
+        // Payload of each plane; multi-planar drivers may put a header
+        // in front of the data (data_offset)
+        DequeuedBuffer in;
+        in.index = buff.index;
+        for (uint32_t p = 0; p < numPlanes; ++p) {
+            const Buffer& mapped = session.stream->buffers[buff.index].planes[p];
+            size_t offset = session.multiplanar ? planes[p].data_offset : 0;
+            size_t used = session.multiplanar ? planes[p].bytesused : buff.bytesused;
+            offset = std::min(offset, mapped.length);
+            in.data[p] = static_cast<uint8_t*>(mapped.start) + offset;
+            in.size[p] = std::min(used, mapped.length) > offset ? std::min(used, mapped.length) - offset : 0;
+            in.capacity[p] = mapped.length - offset;
+        }
 
-            const uint8_t* frameData = static_cast<uint8_t*>(buffers[buff.index].start);
-            size_t frameSize = buff.bytesused;
+        if (session.warmupFrames > 0){
+            --session.warmupFrames;
+            session.QueueBuffer(buff.index); // re-queue buffer
+            return; // skip processing during warmup
+        }
 
-            if (warmupFrames > 0){
-                --warmupFrames;
-                xioctl(fd, VIDIOC_QBUF, &buff); // re-queue buffer
-                continue; // skip processing during warmup
+        m_FramesCaptured.fetch_add(1, std::memory_order_relaxed);
+
+        // UVC buffers are stamped with CLOCK_MONOTONIC at the start of the
+        // frame, the same clock steady_clock reads on Linux. Drivers that
+        // copy or don't set timestamps get the dequeue time instead, so A/V
+        // sync always compares times on one clock.
+        const int64_t dequeueTimeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        if ((buff.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) == V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC) {
+            in.captureTimeNs = static_cast<int64_t>(buff.timestamp.tv_sec) * 1000000000LL +
+                               static_cast<int64_t>(buff.timestamp.tv_usec) * 1000LL;
+        } else {
+            in.captureTimeNs = dequeueTimeNs;
+        }
+        if (in.captureTimeNs > 0 && dequeueTimeNs >= in.captureTimeNs) {
+            double captureMs = (dequeueTimeNs - in.captureTimeNs) / 1e6;
+            double avg = m_AvgCaptureLatencyMs.load(std::memory_order_relaxed);
+            m_AvgCaptureLatencyMs.store(avg == 0.0 ? captureMs : avg * 0.95 + captureMs * 0.05, std::memory_order_relaxed);
+        }
+
+        if (!m_DecodeEnabled.load(std::memory_order_relaxed)) {
+            m_FramesSuspended.fetch_add(1, std::memory_order_relaxed);
+            session.Dropped();
+            session.QueueBuffer(buff.index); // re-queue buffer
+            return;
+        }
+
+        if (session.strand) {
+            // Hand the buffer to the pool under a lease, unless that would
+            // leave the driver fewer than two to fill - then the pool is
+            // behind and this frame is dropped rather than stall capture
+            if (session.stream->leased.load(std::memory_order_relaxed) + 3 > session.bufferCount) {
+                m_FramesOverrun.fetch_add(1, std::memory_order_relaxed);
+                session.Dropped();
+                session.QueueBuffer(buff.index); // re-queue buffer
+                return;
+            }
+            auto held = LeaseBuffer(session.stream, buff.index);
+            if (!session.strand->Post([this, owner, in, held] { DecodeBuffer(*owner, in, held); })) {
+                // Job dropped with its lease; the buffer comes back through returnFd
+                m_FramesOverrun.fetch_add(1, std::memory_order_relaxed);
+                session.Dropped();
+            }
+            return;
+        }
+
+        // No pool: decode right here on the reactor thread
+        if (!DecodeBuffer(session, in, nullptr)) {
+            session.QueueBuffer(buff.index); // re-queue buffer
+        }
+    }
+
+    bool VideoCapture::DecodeBuffer(CaptureSession& session, const DequeuedBuffer& in, const std::shared_ptr<const void>& held) {
+        const uint8_t* frameData = in.data[0];
+        size_t frameSize = in.size[0];
+
+        // Capture cards repeat byte-identical JPEGs for static sources or
+        // no signal. The previous decoded frame is still on screen, so
+        // skip decode and upload entirely.
+        uint64_t fingerprint = 0;
+        if (session.isMjpeg) {
+            int scale = m_DecodeScale.load(std::memory_order_relaxed);
+            // Compared with the last request, not the active scale: the
+            // decoder may round it or fail to switch, and asking again every
+            // frame would reopen the codec and defeat duplicate skipping
+            if (scale != m_RequestedDecodeScale) {
+                m_RequestedDecodeScale = scale;
+                m_mjpegDecoder->SetScaleDenominator(scale);
+                m_ActiveDecodeScale.store(m_mjpegDecoder->GetScaleDenominator(), std::memory_order_relaxed);
+                session.haveLastPayload = false; // force a decode at the new size
+            }
+
+            fingerprint = PayloadFingerprint(frameData, frameSize);
+            if (session.haveLastPayload && fingerprint == session.lastFingerprint && frameSize == session.lastPayloadSize) {
+                m_FramesDuplicate.fetch_add(1, std::memory_order_relaxed);
+                return false;
             }
+        }
+
+        const NegotiatedFormat& negotiated = session.negotiated;
+        Frame frame;
+        bool success = false;
+        bool pending = false;
+        bool leased = false;
+        int64_t frameTimeNs = in.captureTimeNs;
+        auto decodeStart = std::chrono::steady_clock::now();
+        double decodeMs = 0.0;
 
-            int width, height;
-            std::vector<uint8_t> rgbData;
-            bool success = false;
-            
-            if (m_Format == "YUYV") {
-                width = m_Width;
-                height = m_Height;
-                success = m_yuyvDecoder->DecodeToRGB(frameData, width, height, rgbData);
+        if (session.isH264) {
+            // The decoder may hold access units back, so the picture that
+            // comes out belongs to an earlier buffer; its own submit time
+            // is the start of the decode latency
+            if (session.h264Resync.exchange(false, std::memory_order_relaxed)) {
+                // Access units were dropped (or the stream is new): restart
+                // from the next IDR and ask the encoder for one now rather
+                // than wait out its GOP
+                m_h264Decoder->Flush();
+                if (session.keyFrameControl) {
+                    v4l2_control control{};
+                    control.id = V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME;
+                    control.value = 1;
+                    session.keyFrameControl = xioctl(session.stream->fd, VIDIOC_S_CTRL, &control) == 0;
+                }
+            }
+            DecodedPicture picture;
+            const DecodeStatus status = m_h264Decoder->Decode(frameData, frameSize, in.captureTimeNs, frame, picture);
+            success = status == DecodeStatus::Picture;
+            if (success) {
+                frameTimeNs = picture.captureTimeNs;
+                decodeMs = picture.decodeLatencyMs;
             } else {
-                success = m_mjpegDecoder->DecodeToRGB(frameData, frameSize, width, height, rgbData);
+                pending = status == DecodeStatus::NeedMore; // not a failure; the decoder is filling its pipeline
             }
-            
+        } else if (session.isPassthrough) {
+            // No CPU colour conversion (and no truncation of 10-bit
+            // samples): the renderer uploads the planes as textures and
+            // converts in the shader
+            frame.format = session.frameFormat;
+            frame.width = negotiated.width;
+            frame.height = negotiated.height;
+            frame.matrix = session.matrix;
+            frame.fullRange = session.fullRange;
+            success = DescribeV4L2Planes(in.data, in.size, negotiated.numPlanes, negotiated.stride, frame);
+            if (success) {
+                // Lend the mmap buffer itself while the driver keeps at
+                // least two to fill; otherwise copy so capture never stalls
+                const uint32_t leasedAfter = session.stream->leased.load(std::memory_order_relaxed) + (held ? 0 : 1);
+                if (leasedAfter + 2 <= session.bufferCount) {
+                    frame.storage = held ? held : LeaseBuffer(session.stream, in.index);
+                    frame.deviceBuffer = true;
+                    leased = true;
+                } else {
+                    frame = m_FramePool.Copy(frame);
+                }
+            }
+        } else if (!session.isMjpeg) {
+            int width = negotiated.width;
+            int height = negotiated.height;
+            auto buffer = m_FramePool.Acquire();
+            // Rows are split over the job system's workers, so one large
+            // frame doesn't wait on a single core
+            success = session.converter->Convert(frameData, frameSize, width, height, negotiated.stride[0], *buffer,
+                                                 m_DecoderPool ? &m_DecoderPool->Jobs() : nullptr) &&
+                      FramePool::WrapBuffer(std::move(buffer), FrameFormat::RGB24, width, height, frame);
+        } else {
+            // Decode straight out of the mmap buffer; the decoder's
+            // reference is dropped before the buffer is re-queued
+            success = m_mjpegDecoder->DecodeToFrame(in.data[0], frameSize, in.capacity[0], frame);
             if (success) {
-                Frame frame;
-                frame.width = width;
-                frame.height = height;
-                frame.data = std::move(rgbData);
-                m_RingBuffer->push(std::move(frame));
+                session.haveLastPayload = true;
+                session.lastFingerprint = fingerprint;
+                session.lastPayloadSize = frameSize;
             }
-            xioctl(fd, VIDIOC_QBUF, &buff); // re-queue buffer
         }
-        xioctl( fd, VIDIOC_STREAMOFF, &type);
-        for (size_t i = 0; i < reqBuffer.count; ++i){
-            munmap(buffers[i].start, buffers[i].length);
+
+        if (!session.isH264) {
+            decodeMs = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - decodeStart).count();
         }
-        close(fd);
-        } catch (const std::exception& e) {
-            std::cerr << "Video capture error: " << e.what() << std::endl;
-            m_Running = false;
+        if (success) {
+            m_FramesDecoded.fetch_add(1, std::memory_order_relaxed);
+            double avg = m_AvgDecodeMs.load(std::memory_order_relaxed);
+            m_AvgDecodeMs.store(avg == 0.0 ? decodeMs : avg * 0.95 + decodeMs * 0.05, std::memory_order_relaxed);
+
+            frame.timestamp = static_cast<uint64_t>(frameTimeNs);
+            m_Bus.Publish(frame);
+        } else if (!pending) {
+            m_FramesFailed.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (session.isMjpeg) {
+            m_mjpegDecoder->ReleaseInput();
         }
+        return leased;
     }
 
-}
\ No newline at end of file
+}
@@ -1,20 +1,27 @@
 #ifndef VIDEO_CAPTURE_H
 #define VIDEO_CAPTURE_H
 
+#include "../core/IoReactor.h"
+#include "CaptureStats.h"
+#include "DecoderPool.h"
 #include "Frame.h"
-#include "MjpgDecoder.h"
-#include "YuyvDecoder.h"
-#include "RingBuffer.h"
+#include "FrameBus.h"
+#include "FramePool.h"
+#include "H264Decoder.h"
+#include "MjpgBackend.h"
+#include "PixelConverter.h"
 #include <atomic>
 #include <memory>
-#include <optional>
 #include <string>
-#include <thread>
 
 namespace uvc2gl {
+    struct CaptureSession;
+    struct DequeuedBuffer;
+
     class VideoCapture {
         public:
-            VideoCapture(std::string device, int width, int height, int fps, std::string format, size_t ringBufferSize);
+            VideoCapture(std::string device, int width, int height, int fps, std::string format,
+                         const std::string& mjpegBackend = "ffmpeg");
             ~VideoCapture();
 
             VideoCapture(const VideoCapture&) = delete;
@@ -24,21 +31,72 @@ namespace uvc2gl {
             void Stop();
             bool IsRunning() const { return m_Running.load(); }
 
-            std::optional<Frame> GetFrame();
+            // Every decoded frame is published here; subscribe to receive them
+            FrameBus& Bus() { return m_Bus; }
+            CaptureStats GetStats() const;
+
+            // MJPEG, H.264 or any FourCC in PixelConverterRegistry
+            static bool SupportsFormat(uint32_t pixelFormat);
+
+            // When disabled the stream keeps running (buffers are dequeued and
+            // re-queued) but nothing is decoded or pushed - used while hidden
+            void SetDecodeEnabled(bool enabled) { m_DecodeEnabled.store(enabled, std::memory_order_relaxed); }
+
+            // Frame layouts the consumer can render; RGB24 is always produced
+            // as a fallback. Read when capture starts. Planar YCbCr lets the
+            // decoders hand out their own pictures without a swscale pass.
+            void SetOutputFormats(FrameFormatMask formats) { m_OutputFormats.store(formats | FrameFormatBit(FrameFormat::RGB24), std::memory_order_relaxed); }
+
+            // Run the device on a reactor shared with other captures (one
+            // is created on Start() otherwise). Set before Start().
+            void SetReactor(std::shared_ptr<IoReactor> reactor) { m_Reactor = std::move(reactor); }
+
+            // Decode on a pool shared with other captures instead of the
+            // reactor thread. Read when capture starts.
+            void SetDecoderPool(std::shared_ptr<DecoderPool> pool) { m_DecoderPool = std::move(pool); }
+
+            // Requested MJPEG DCT downscale (1, 2, 4 or 8), applied on the next frame
+            void SetDecodeScale(int denominator) { m_DecodeScale.store(denominator, std::memory_order_relaxed); }
 
         private:
-            void CaptureLoop();
+            std::shared_ptr<CaptureSession> OpenSession();
+            // Reactor handlers for the device fd and the lease-return eventfd
+            void OnDeviceReady(const std::shared_ptr<CaptureSession>& session, uint32_t events);
+            void OnBuffersReturned(const std::shared_ptr<CaptureSession>& session);
+            // Decodes and publishes one buffer, on the reactor or a pool
+            // thread; returns true if a Frame now leases it
+            bool DecodeBuffer(CaptureSession& session, const DequeuedBuffer& in, const std::shared_ptr<const void>& held);
+
             std::string m_Device;
             int m_Width;
             int m_Height;
             int m_FPS;
             std::string m_Format;
+            uint32_t m_PixelFormat;
 
-            std::unique_ptr<RingBuffer> m_RingBuffer;
-            std::unique_ptr<MjpgDecoder> m_mjpegDecoder;
-            std::unique_ptr<YuyvDecoder> m_yuyvDecoder;
-            std::thread m_CaptureThread;
+            FrameBus m_Bus;
+            std::unique_ptr<MjpgBackend> m_mjpegDecoder;
+            std::unique_ptr<H264Decoder> m_h264Decoder;
+            std::shared_ptr<DecoderPool> m_DecoderPool;
+            FramePool m_FramePool;
+            std::shared_ptr<IoReactor> m_Reactor;
+            std::shared_ptr<CaptureSession> m_Session; // Start/Stop only
             std::atomic<bool> m_Running;
+
+            // Stats (written by reactor or pool thread, read by main thread)
+            std::atomic<uint64_t> m_FramesCaptured{0};
+            std::atomic<uint64_t> m_FramesDecoded{0};
+            std::atomic<uint64_t> m_FramesDuplicate{0};
+            std::atomic<uint64_t> m_FramesFailed{0};
+            std::atomic<uint64_t> m_FramesSuspended{0};
+            std::atomic<uint64_t> m_FramesOverrun{0};
+            std::atomic<double> m_AvgDecodeMs{0.0};
+            std::atomic<double> m_AvgCaptureLatencyMs{0.0};
+            std::atomic<bool> m_DecodeEnabled{true};
+            std::atomic<int> m_DecodeScale{1};
+            std::atomic<int> m_ActiveDecodeScale{1};
+            int m_RequestedDecodeScale = 1;  // Last scale passed to m_mjpegDecoder (decode side only)
+            std::atomic<FrameFormatMask> m_OutputFormats{FrameFormatBit(FrameFormat::RGB24)};
     };
 }
 